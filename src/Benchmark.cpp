@@ -0,0 +1,164 @@
+/* date = October 17, 2026 10:02 AM */
+
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include "Graph.h"
+#include "RS-FEC.h"
+#include "common.h"
+
+namespace DS {
+    using FEC = RS::ReedSolomon<MSG_LENGTH, ECC_LENGTH>;
+
+    // number of frames pushed through every kernel; large enough to take a few hundred milliseconds
+    constexpr size_t BENCH_FRAMES = 1 << 18;
+    // symbol errors injected into every damaged frame (the code corrects up to ECC_LENGTH / 2)
+    constexpr int BENCH_ERRORS = 3;
+
+    // runs `fn` once over all frames and prints the throughput
+    template<typename F>
+    static void measure(const char *name, F &&fn) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double fps = static_cast<double>(BENCH_FRAMES) / secs;
+        printf("  %-32s %12.0f frames/s %9.1f MB/s\n", name, fps, fps * BUFFER_LENGTH / 1e6);
+    }
+
+    void fec_benchmark() {
+        FEC rs{};
+        std::vector<uint8_t> messages(BENCH_FRAMES * MSG_LENGTH);
+        std::vector<uint8_t> clean(BENCH_FRAMES * BUFFER_LENGTH);
+        std::vector<uint8_t> damaged(BENCH_FRAMES * BUFFER_LENGTH);
+        std::vector<uint8_t> out(BENCH_FRAMES * BUFFER_LENGTH);
+        std::vector<uint8_t> synd(BENCH_FRAMES * ECC_LENGTH);
+
+        srand(1);
+        for (auto &b: messages) b = rand();
+        for (size_t f = 0; f < BENCH_FRAMES; f++) {
+            rs.Encode(&messages[f * MSG_LENGTH], &clean[f * BUFFER_LENGTH]);
+        }
+        damaged = clean;
+        for (size_t f = 0; f < BENCH_FRAMES; f++) {
+            for (int e = 0; e < BENCH_ERRORS; e++) {
+                damaged[f * BUFFER_LENGTH + rand() % BUFFER_LENGTH] ^= 1 + rand() % 255;
+            }
+        }
+
+        printf("RS(%zu, %d) benchmark, %zu frames, best instruction set: %s\n",
+               BUFFER_LENGTH, MSG_LENGTH, BENCH_FRAMES, RS::simd::isa_name(RS::simd::best_isa()));
+
+        for (int i = RS::simd::ISA_SCALAR; i <= RS::simd::best_isa(); i++) {
+            const auto isa = static_cast<RS::simd::Isa>(i);
+            printf("%s:\n", RS::simd::isa_name(isa));
+
+            measure("encode", [&] {
+                for (size_t f = 0; f < BENCH_FRAMES; f++) {
+                    RS::simd::encode(FEC::GeneratorTable(), &messages[f * MSG_LENGTH], MSG_LENGTH,
+                                     &out[f * BUFFER_LENGTH + MSG_LENGTH], isa);
+                }
+            });
+            measure("frame syndromes (damaged)", [&] {
+                for (size_t f = 0; f < BENCH_FRAMES; f++) {
+                    RS::simd::frame_syndromes(&damaged[f * BUFFER_LENGTH], BUFFER_LENGTH, ECC_LENGTH,
+                                              &synd[f * ECC_LENGTH], isa);
+                }
+            });
+            measure("batch syndromes (clean)", [&] {
+                RS::simd::syndromes(clean.data(), BENCH_FRAMES, BUFFER_LENGTH, ECC_LENGTH, synd.data(), isa);
+            });
+            measure("batch syndromes (damaged)", [&] {
+                RS::simd::syndromes(damaged.data(), BENCH_FRAMES, BUFFER_LENGTH, ECC_LENGTH, synd.data(), isa);
+            });
+        }
+
+        printf("decoder (%s kernels):\n", RS::simd::isa_name(RS::simd::best_isa()));
+        size_t failed = 0;
+        measure("decode (clean)", [&] {
+            for (size_t f = 0; f < BENCH_FRAMES; f++) {
+                failed += rs.Correct(&clean[f * BUFFER_LENGTH], &out[f * BUFFER_LENGTH]) == FEC::DECODE_FAILED;
+            }
+        });
+        measure("decode (3 errors per frame)", [&] {
+            for (size_t f = 0; f < BENCH_FRAMES; f++) {
+                failed += rs.Correct(&damaged[f * BUFFER_LENGTH], &out[f * BUFFER_LENGTH]) == FEC::DECODE_FAILED;
+            }
+        });
+
+        if (failed) {
+            printf("warning: %zu frames failed to decode\n", failed);
+        }
+    }
+
+    // graph updates per second, as the UI thread does at 60 frames a second
+    constexpr double GRAPH_BENCH_RATE = 60.0;
+    constexpr double GRAPH_BENCH_SHORT = MIN_TO_SEC;
+    constexpr double GRAPH_BENCH_LONG = 10 * HOUR_TO_SEC;
+    // frames timed per measurement, and measurements per case (the fastest is kept, to leave out scheduler noise)
+    constexpr int GRAPH_BENCH_FRAMES = 2000;
+    constexpr int GRAPH_BENCH_REPEATS = 5;
+    // how much slower a frame of the long session may be than one of the short session
+    constexpr double GRAPH_BENCH_MAX_RATIO = 2.0;
+
+    // a graph holding `seconds` of a noisy sine wave, sampled at GRAPH_BENCH_RATE
+    static Graph bench_graph(const double seconds, const double width) {
+        Graph g{"bench", "0", width};
+        srand(1);
+        const auto n = static_cast<size_t>(seconds * GRAPH_BENCH_RATE);
+        for (size_t i = 0; i < n; i++) {
+            const double t = static_cast<double>(i) / GRAPH_BENCH_RATE;
+            g.push(t, std::sin(t / 10) + static_cast<double>(rand() % 1000) / 10000);
+        }
+        return g;
+    }
+
+    // fastest time of GRAPH_BENCH_REPEATS runs, in nanoseconds per frame, of everything `display` does before ImPlot
+    static double time_frame(const Graph &g, size_t &points) {
+        double best = std::numeric_limits<double>::infinity();
+        for (int r = 0; r < GRAPH_BENCH_REPEATS; r++) {
+            double sink = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (int f = 0; f < GRAPH_BENCH_FRAMES; f++) {
+                std::span<const double> xs, ys;
+                g.visible(xs, ys);
+                if (!ys.empty()) {
+                    sink += *std::ranges::max_element(ys);
+                }
+                points = xs.size();
+            }
+            const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).
+                              count();
+            // keeps the loop from being optimized away
+            if (sink == std::numeric_limits<double>::infinity()) printf(" ");
+            best = std::min(best, ns / GRAPH_BENCH_FRAMES);
+        }
+        return best;
+    }
+
+    int graph_benchmark() {
+        constexpr double widths[] = {DEFAULT_GRAPH_WIDTH, 10 * MIN_TO_SEC, HOUR_TO_SEC};
+        printf("Graph render benchmark, %.0f samples/s, %.0f s vs %.0f s of data, limit %.1fx\n", GRAPH_BENCH_RATE,
+               GRAPH_BENCH_SHORT, GRAPH_BENCH_LONG, GRAPH_BENCH_MAX_RATIO);
+
+        int status = 0;
+        for (const double width: widths) {
+            size_t short_points, long_points;
+            const double short_ns = time_frame(bench_graph(GRAPH_BENCH_SHORT, width), short_points);
+            const double long_ns = time_frame(bench_graph(GRAPH_BENCH_LONG, width), long_points);
+            const double ratio = long_ns / short_ns;
+            const bool ok = ratio <= GRAPH_BENCH_MAX_RATIO;
+            printf("  %6.0f s window: %9.0f ns/frame (%6zu points) vs %9.0f ns/frame (%6zu points), %.2fx %s\n",
+                   width, short_ns, short_points, long_ns, long_points, ratio, ok ? "ok" : "TOO SLOW");
+            if (!ok) status = 1;
+        }
+        return status;
+    }
+} // DS
@@ -0,0 +1,23 @@
+/* date = October 17, 2026 10:02 AM */
+
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+namespace DS {
+    /**
+     * Microbenchmark for the RS-FEC code. Prints frames per second for encoding, decoding clean and damaged
+     * packets, and single-frame and batch syndrome checks, once for every instruction set the running CPU supports.
+     */
+    void fec_benchmark();
+
+    /**
+     * Regression check for graph rendering. Fills graphs with 1 minute and with 10 hours of samples and times what
+     * every frame does before handing points to ImPlot (picking a pyramid level, the binary search and the visible
+     * span) for a few window widths.
+     * @return 0 if the long session costs at most GRAPH_BENCH_MAX_RATIO times the short one for every width, else 1.
+     */
+    int graph_benchmark();
+} // DS
+
+#endif //BENCHMARK_H
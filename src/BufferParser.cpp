@@ -3,6 +3,8 @@
 
 #include "BufferParser.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <iostream>
@@ -42,23 +44,57 @@ namespace DS {
         bool end_of_buffer = buf_idx == BUFFER_LENGTH;
 
         if (end_of_buffer) {
-            // validate buffer
+            finish_frame();
+        }
+    }
+
+    size_t BufferParser::put_bytes(std::span<const uint8_t> bytes) {
+        size_t i = 0;
+        while (i < bytes.size() && !buffer_ready) {
+            if (!reading) {
+                // header search has to look at every byte anyway
+                put_byte(bytes[i++]);
+                continue;
+            }
+
+            // fill mode: copy as much of the packet as this chunk holds in one go
+            const size_t n = std::min(bytes.size() - i, BUFFER_LENGTH - buf_idx);
+            memcpy(buffer + buf_idx, bytes.data() + i, n);
+            buf_idx += n;
+            i += n;
+
+            if (buf_idx == BUFFER_LENGTH) {
+                finish_frame();
+            }
+        }
+        return i;
+    }
 
-            // re-encode ReedSolomon
-            auto decoded = new uint8_t[BUFFER_LENGTH];
-            //rs.Decode(buffer, decoded);
-            memcpy(decoded, buffer, BUFFER_LENGTH);
-            // create and digest buffer
-            // emplace_back takes the parameters for the constructor of a class and places uses them to "emplace" a new
-            // object in the vector using a constructor assumed by the compiler.
+    void BufferParser::finish_frame() {
+        reading = false;
+        buf_idx = 0;
 
-            this->packaged_buffer = Buffer(decoded);
-            this->buffer_ready = true;
+        // validate buffer and correct it with ReedSolomon. Clean packets stop after the syndrome check.
+        uint8_t decoded[BUFFER_LENGTH];
+        const auto status = rs.Correct(buffer, decoded);
 
-            delete[] decoded;
+        if (status == RS::ReedSolomon<MSG_LENGTH, ECC_LENGTH>::DECODE_FAILED) {
+            // the type byte may be garbage too, so anything we don't recognize goes in the undefined bucket.
+            const BufferType type = from_id(buffer[MESSAGE_TYPE_BYTE]).value_or(UndefinedMessage);
+            fec_uncorrectable[type].fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
 
-            reading = false;
-            buf_idx = 0;
+        const BufferType type = from_id(decoded[MESSAGE_TYPE_BYTE]).value_or(UndefinedMessage);
+        if (status == RS::ReedSolomon<MSG_LENGTH, ECC_LENGTH>::DECODE_CORRECTED) {
+            fec_corrected[type].fetch_add(1, std::memory_order_relaxed);
+        } else {
+            fec_clean[type].fetch_add(1, std::memory_order_relaxed);
         }
+
+        this->packaged_buffer = Buffer(decoded);
+        this->packaged_buffer.received_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        this->buffer_ready = true;
     }
 } // DS
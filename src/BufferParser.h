@@ -4,7 +4,10 @@
 #ifndef BUFFERPARSER_H
 #define BUFFERPARSER_H
 
+#include <array>
+#include <atomic>
 #include <optional>
+#include <span>
 #include <string>
 
 #include "common.h"
@@ -60,6 +63,18 @@ namespace DS {
             uint8_t length{0};
             // Timestamp of received message
             int timestamp{0};
+            // Host steady_clock time, in nanoseconds, at which the packet finished decoding
+            int64_t received_ns{0};
+        };
+
+        /**
+         * Per-message-type Reed-Solomon statistics. `clean` packets had no errors, `corrected` packets had errors
+         * that were fixed, and `uncorrectable` packets were dropped.
+         */
+        struct FecStats {
+            uint32_t clean{};
+            uint32_t corrected{};
+            uint32_t uncorrectable{};
         };
 
         BufferParser() = default;
@@ -73,6 +88,18 @@ namespace DS {
          */
         void put_byte(uint8_t c);
 
+        /**
+         * Bulk version of `put_byte`. Bytes are consumed from the front of `bytes` until either the span is
+         * exhausted or a full buffer has been parsed, whichever comes first. Once a packet is in the buffer, the
+         * rest of it is copied in one go instead of byte by byte.
+         *
+         * If `ready()` is true when this returns, take the buffer with `get_buffer()` and call this again with
+         * the remaining bytes.
+         * @param bytes Raw bytes received from serial.
+         * @return Number of bytes consumed from the front of `bytes`.
+         */
+        size_t put_bytes(std::span<const uint8_t> bytes);
+
         /**
          * This function gives a reference to the last valid buffer the BufferParser has created. Upon doing so, the parser
          * considers itself "empty", and ready to begin parsing a new buffer.
@@ -83,6 +110,21 @@ namespace DS {
             return packaged_buffer;
         }
 
+        /**
+         * Safe to call from any thread while the parser is running.
+         * @param type Message type to query. Packets too damaged to tell their type are counted under
+         * `UndefinedMessage`.
+         * @return FEC statistics for packets of that type since the parser was created.
+         */
+        [[nodiscard]] FecStats fec_stats(const BufferType type) const {
+            const size_t i = type < NumTypes ? type : UndefinedMessage;
+            return {
+                fec_clean[i].load(std::memory_order_relaxed),
+                fec_corrected[i].load(std::memory_order_relaxed),
+                fec_uncorrectable[i].load(std::memory_order_relaxed),
+            };
+        }
+
         /**
          * Read return.
          * @return If a buffer has been parsed since the last one received.
@@ -107,6 +149,10 @@ namespace DS {
         }
 
     private:
+        // Decodes the full frame sitting in `buffer`, packages it (unless it can't be corrected) and returns to
+        // validate mode.
+        void finish_frame();
+
         // true if we're currently filling out the buffer. false otherwise
         bool reading = false;
         // current index into buffer data (used while actively reading new bytes)
@@ -120,6 +166,11 @@ namespace DS {
 
         // TODO: we have a duplicate RS encoder in Dashboard.h
         RS::ReedSolomon<MSG_LENGTH, ECC_LENGTH> rs{};
+
+        // written by the parsing thread, read by the UI
+        std::array<std::atomic<uint32_t>, NumTypes> fec_clean{};
+        std::array<std::atomic<uint32_t>, NumTypes> fec_corrected{};
+        std::array<std::atomic<uint32_t>, NumTypes> fec_uncorrectable{};
     };
 } // DS
 
@@ -0,0 +1,109 @@
+/* date = October 17, 2026 10:25 PM */
+
+
+#include "Capture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace DS {
+    static_assert((CAPTURE_RING_BYTES & (CAPTURE_RING_BYTES - 1)) == 0, "capture ring must be a power of two");
+
+    Capture::~Capture() {
+        close();
+    }
+
+    bool Capture::open(const std::filesystem::path &path) {
+        close();
+        file = fopen(path.string().c_str(), "wb");
+        if (!file) {
+            std::cerr << "Capture: could not open " << path << "\n";
+            return false;
+        }
+        // the ring already batches writes
+        setvbuf(file, nullptr, _IONBF, 0);
+
+        uint8_t header[CAPTURE_HEADER_SIZE]{};
+        memcpy(header, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+        memcpy(header + sizeof(CAPTURE_MAGIC), &CAPTURE_VERSION, sizeof(CAPTURE_VERSION));
+        fwrite(header, 1, sizeof(header), file);
+
+        ring = std::make_unique<uint8_t[]>(CAPTURE_RING_BYTES);
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        stopping.store(false, std::memory_order_relaxed);
+        writer = std::thread(&Capture::run, this);
+        return true;
+    }
+
+    void Capture::close() {
+        if (!file) return;
+        stopping.store(true, std::memory_order_release);
+        writer.join();
+        fclose(file);
+        file = nullptr;
+        ring.reset();
+    }
+
+    void Capture::record(const std::span<const uint8_t> bytes) {
+        if (!file || bytes.empty()) return;
+
+        const size_t need = CAPTURE_CHUNK_HEADER_SIZE + bytes.size();
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (CAPTURE_RING_BYTES - (h - tail.load(std::memory_order_acquire)) < need) {
+            dropped_bytes.fetch_add(bytes.size(), std::memory_order_relaxed);
+            return;
+        }
+
+        uint8_t chunk_header[CAPTURE_CHUNK_HEADER_SIZE];
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        const auto length = static_cast<uint32_t>(bytes.size());
+        memcpy(chunk_header, &now, sizeof(now));
+        memcpy(chunk_header + sizeof(now), &length, sizeof(length));
+
+        // the whole chunk goes in before `head` moves, so the writer never sees half of one
+        size_t at = h;
+        auto put = [this, &at](const uint8_t *src, size_t n) {
+            while (n) {
+                const size_t pos = at & (CAPTURE_RING_BYTES - 1);
+                const size_t run = std::min(n, CAPTURE_RING_BYTES - pos);
+                memcpy(ring.get() + pos, src, run);
+                src += run;
+                n -= run;
+                at += run;
+            }
+        };
+        put(chunk_header, sizeof(chunk_header));
+        put(bytes.data(), bytes.size());
+        head.store(at, std::memory_order_release);
+    }
+
+    void Capture::drain() {
+        size_t t = tail.load(std::memory_order_relaxed);
+        const size_t h = head.load(std::memory_order_acquire);
+        while (t != h) {
+            const size_t pos = t & (CAPTURE_RING_BYTES - 1);
+            const size_t run = std::min(h - t, CAPTURE_RING_BYTES - pos);
+            if (fwrite(ring.get() + pos, 1, run, file) != run) {
+                std::cerr << "Capture: write failed\n";
+            }
+            t += run;
+        }
+        tail.store(t, std::memory_order_release);
+    }
+
+    void Capture::run() {
+        for (;;) {
+            const bool stop = stopping.load(std::memory_order_acquire);
+            const bool idle = head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed);
+            drain();
+            if (stop) break;
+            if (idle) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(LOG_IDLE_SLEEP_MS));
+            }
+        }
+    }
+} // DS
@@ -0,0 +1,88 @@
+/* date = October 17, 2026 10:25 PM */
+
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <thread>
+
+#include "SPSCQueue.h"
+#include "common.h"
+
+namespace DS {
+    /*
+     * Capture file ("*.dscap") layout, integers in host (little-endian) byte order:
+     *   header  "DSCAP" magic (8 bytes), version (u32), reserved (u32)
+     *   chunks  host steady_clock nanoseconds of the read (i64), length (u32), then that many raw serial bytes
+     */
+    constexpr char CAPTURE_MAGIC[8] = {'D', 'S', 'C', 'A', 'P', 0, 0, 0};
+    constexpr uint32_t CAPTURE_VERSION = 1;
+    constexpr size_t CAPTURE_HEADER_SIZE = 16;
+    constexpr size_t CAPTURE_CHUNK_HEADER_SIZE = sizeof(int64_t) + sizeof(uint32_t);
+
+    /**
+     * Tees the raw serial stream, exactly as read and before any parsing, into a capture file.
+     *
+     * `record` only copies the bytes into a large ring buffer; a background thread writes the ring out. If the disk
+     * falls so far behind that a chunk doesn't fit, the chunk is dropped and counted rather than blocking the reader.
+     */
+    class Capture {
+    public:
+        Capture() = default;
+        ~Capture();
+
+        Capture(const Capture &) = delete;
+        Capture &operator=(const Capture &) = delete;
+
+        /**
+         * Creates `path` and starts the writer thread. Errors are printed.
+         * @return false if the file couldn't be created.
+         */
+        bool open(const std::filesystem::path &path);
+
+        /**
+         * Writes out everything recorded so far, then stops the writer and closes the file.
+         */
+        void close();
+
+        /**
+         * Queues one read's worth of bytes, stamped with the current host time. Never blocks.
+         * NOTE: only one thread may call this.
+         */
+        void record(std::span<const uint8_t> bytes);
+
+        [[nodiscard]] bool is_open() const {
+            return file != nullptr;
+        }
+
+        /**
+         * @return Bytes dropped because the writer fell behind.
+         */
+        [[nodiscard]] uint64_t dropped() const {
+            return dropped_bytes.load(std::memory_order_relaxed);
+        }
+
+    private:
+        void run();
+        // writes out everything between tail and head
+        void drain();
+
+        FILE *file = nullptr;
+        std::unique_ptr<uint8_t[]> ring;
+
+        // total bytes ever written into / read out of the ring; positions are taken modulo CAPTURE_RING_BYTES
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> head{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> dropped_bytes{0};
+
+        std::atomic<bool> stopping{false};
+        std::thread writer;
+    };
+} // DS
+
+#endif //CAPTURE_H
@@ -0,0 +1,435 @@
+/* date = October 17, 2026 8:50 PM */
+
+
+#include "ColumnStore.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <ranges>
+#include <type_traits>
+
+namespace DS {
+    static constexpr char COLUMN_MAGIC[8] = {'D', 'S', 'C', 'O', 'L', 0, 0, 0};
+    static constexpr uint32_t COLUMN_VERSION = 1;
+
+    struct ColumnFileHeader {
+        char magic[8];
+        uint32_t version;
+        uint8_t ty;
+        uint8_t codec;
+        uint8_t reserved[2];
+    };
+    static_assert(sizeof(ColumnFileHeader) == 16);
+
+    static uint64_t zigzag(const int64_t v) {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    static int64_t unzigzag(const uint64_t v) {
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+
+    static void put_varint(std::vector<uint8_t> &out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    // false if the varint runs past the end
+    static bool get_varint(const uint8_t *&p, const uint8_t *end, uint64_t &v) {
+        v = 0;
+        for (unsigned shift = 0; p != end && shift < 64; shift += 7) {
+            const uint8_t b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    // most significant bit first
+    class BitWriter {
+    public:
+        explicit BitWriter(std::vector<uint8_t> &out) : out(out) {
+        }
+
+        void put(const uint64_t v, const unsigned bits) {
+            if (bits > 32) {
+                put(v >> 32, bits - 32);
+                put(v, 32);
+                return;
+            }
+            acc = acc << bits | (v & ((uint64_t{1} << bits) - 1));
+            n += bits;
+            while (n >= 8) {
+                n -= 8;
+                out.push_back(static_cast<uint8_t>(acc >> n));
+            }
+            acc &= (uint64_t{1} << n) - 1;
+        }
+
+        void finish() {
+            if (n) out.push_back(static_cast<uint8_t>(acc << (8 - n)));
+            acc = 0;
+            n = 0;
+        }
+
+    private:
+        std::vector<uint8_t> &out;
+        uint64_t acc = 0;
+        unsigned n = 0;
+    };
+
+    // reads zeros past the end
+    class BitReader {
+    public:
+        BitReader(const uint8_t *data, const size_t size) : data(data), size(size) {
+        }
+
+        uint64_t get(unsigned bits) {
+            uint64_t v = 0;
+            while (bits) {
+                if (byte >= size) return v << bits;
+                const unsigned avail = 8 - offset;
+                const unsigned take = std::min(avail, bits);
+                const uint64_t chunk = data[byte] >> (avail - take) & ((1u << take) - 1);
+                v = v << take | chunk;
+                bits -= take;
+                offset += take;
+                if (offset == 8) {
+                    offset = 0;
+                    byte++;
+                }
+            }
+            return v;
+        }
+
+    private:
+        const uint8_t *data;
+        size_t size;
+        size_t byte = 0;
+        unsigned offset = 0;
+    };
+
+    static unsigned value_bits(const Config::FieldType ty) {
+        return ty == Config::F32 ? 32 : 64;
+    }
+
+    static void encode(const ColumnCodec codec, const Config::FieldType ty, const std::vector<uint64_t> &values,
+                       std::vector<uint8_t> &out) {
+        switch (codec) {
+            case ColumnCodec::Delta: {
+                uint64_t prev = 0;
+                for (const uint64_t v: values) {
+                    put_varint(out, zigzag(static_cast<int64_t>(v - prev)));
+                    prev = v;
+                }
+                break;
+            }
+            case ColumnCodec::DeltaOfDelta: {
+                uint64_t prev = 0, prev_delta = 0;
+                for (const uint64_t v: values) {
+                    const uint64_t delta = v - prev;
+                    put_varint(out, zigzag(static_cast<int64_t>(delta - prev_delta)));
+                    prev = v;
+                    prev_delta = delta;
+                }
+                break;
+            }
+            case ColumnCodec::Xor: {
+                const unsigned width = value_bits(ty);
+                BitWriter bits{out};
+                uint64_t prev = 0;
+                // bits of the previous XOR that were meaningful; reused while new XORs fit inside them
+                unsigned lead = 0, trail = 0;
+                bool window = false;
+                for (const uint64_t v: values) {
+                    const uint64_t x = v ^ prev;
+                    prev = v;
+                    if (!x) {
+                        bits.put(0, 1);
+                        continue;
+                    }
+                    bits.put(1, 1);
+                    const unsigned lz = std::countl_zero(x) - (64 - width);
+                    const unsigned tz = std::countr_zero(x);
+                    if (window && lz >= lead && tz >= trail) {
+                        bits.put(0, 1);
+                        bits.put(x >> trail, width - lead - trail);
+                    } else {
+                        const unsigned len = width - lz - tz;
+                        bits.put(1, 1);
+                        bits.put(lz, 6);
+                        bits.put(len - 1, 6);
+                        bits.put(x >> tz, len);
+                        lead = lz;
+                        trail = tz;
+                        window = true;
+                    }
+                }
+                bits.finish();
+                break;
+            }
+        }
+    }
+
+    static bool decode_values(const ColumnCodec codec, const Config::FieldType ty, const uint8_t *p,
+                              const uint8_t *end, const uint32_t count, std::vector<uint64_t> &values) {
+        switch (codec) {
+            case ColumnCodec::Delta: {
+                uint64_t prev = 0;
+                for (uint32_t i = 0; i < count; i++) {
+                    uint64_t z;
+                    if (!get_varint(p, end, z)) return false;
+                    prev += static_cast<uint64_t>(unzigzag(z));
+                    values.push_back(prev);
+                }
+                return true;
+            }
+            case ColumnCodec::DeltaOfDelta: {
+                uint64_t prev = 0, prev_delta = 0;
+                for (uint32_t i = 0; i < count; i++) {
+                    uint64_t z;
+                    if (!get_varint(p, end, z)) return false;
+                    prev_delta += static_cast<uint64_t>(unzigzag(z));
+                    prev += prev_delta;
+                    values.push_back(prev);
+                }
+                return true;
+            }
+            case ColumnCodec::Xor: {
+                const unsigned width = value_bits(ty);
+                BitReader bits{p, static_cast<size_t>(end - p)};
+                uint64_t prev = 0;
+                unsigned lead = 0, trail = 0;
+                for (uint32_t i = 0; i < count; i++) {
+                    if (bits.get(1)) {
+                        if (bits.get(1)) {
+                            lead = static_cast<unsigned>(bits.get(6));
+                            const unsigned len = static_cast<unsigned>(bits.get(6)) + 1;
+                            if (lead + len > width) return false;
+                            trail = width - lead - len;
+                        }
+                        prev ^= bits.get(width - lead - trail) << trail;
+                    }
+                    values.push_back(prev);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    ColumnWriter::ColumnWriter(const std::filesystem::path &path, const Config::FieldType ty,
+                               const std::optional<ColumnCodec> codec)
+        : ty(ty) {
+        const bool is_float = ty == Config::F32 || ty == Config::F64;
+        this->codec = codec.value_or(is_float ? ColumnCodec::Xor : ColumnCodec::Delta);
+        values.reserve(COLUMN_BLOCK_VALUES);
+
+        file = fopen(path.string().c_str(), "wb");
+        if (!file) {
+            std::cerr << "ColumnWriter: could not open " << path << "\n";
+            return;
+        }
+        ColumnFileHeader header{};
+        memcpy(header.magic, COLUMN_MAGIC, sizeof(COLUMN_MAGIC));
+        header.version = COLUMN_VERSION;
+        header.ty = static_cast<uint8_t>(ty);
+        header.codec = static_cast<uint8_t>(this->codec);
+        fwrite(&header, sizeof(header), 1, file);
+    }
+
+    ColumnWriter::~ColumnWriter() {
+        seal();
+        if (file) fclose(file);
+    }
+
+    void ColumnWriter::append(const uint8_t *src) {
+        // widen to 64 bits the way `read_block` narrows back: integers keep their sign, floats keep their bits
+        uint64_t bits = 0;
+        const double v = Config::visit_field(ty, src, [&bits](auto x) {
+            using V = decltype(x);
+            if constexpr (std::is_floating_point_v<V>) {
+                memcpy(&bits, &x, sizeof(x));
+            } else if constexpr (std::is_signed_v<V>) {
+                bits = static_cast<uint64_t>(static_cast<int64_t>(x));
+            } else {
+                bits = static_cast<uint64_t>(x);
+            }
+            return static_cast<double>(x);
+        });
+
+        if (values.empty()) {
+            min = std::numeric_limits<double>::infinity();
+            max = -std::numeric_limits<double>::infinity();
+        }
+        // NaN is in no range, so it never widens the block statistics
+        if (v < min) min = v;
+        if (v > max) max = v;
+        values.push_back(bits);
+    }
+
+    void ColumnWriter::seal() {
+        if (values.empty()) return;
+        encoded.clear();
+        encode(codec, ty, values, encoded);
+
+        const ColumnBlockHeader header{
+            static_cast<uint32_t>(values.size()), static_cast<uint32_t>(encoded.size()), min, max,
+        };
+        values.clear();
+        if (!file) return;
+        if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+            fwrite(encoded.data(), 1, encoded.size(), file) != encoded.size()) {
+            std::cerr << "ColumnWriter: write failed\n";
+        }
+    }
+
+    std::optional<ColumnReader> ColumnReader::open(const std::filesystem::path &path) {
+        auto file = MappedFile::open(path);
+        if (!file) return std::nullopt;
+
+        ColumnFileHeader header;
+        if (file->size() < sizeof(header)) {
+            std::cerr << "ColumnReader: " << path << " is not a column file\n";
+            return std::nullopt;
+        }
+        memcpy(&header, file->data(), sizeof(header));
+        if (memcmp(header.magic, COLUMN_MAGIC, sizeof(COLUMN_MAGIC)) != 0 || header.version != COLUMN_VERSION ||
+            header.ty > Config::F64 || header.codec > static_cast<uint8_t>(ColumnCodec::Xor)) {
+            std::cerr << "ColumnReader: " << path << " is not a column file\n";
+            return std::nullopt;
+        }
+
+        ColumnReader reader{std::move(*file)};
+        reader.ty = static_cast<Config::FieldType>(header.ty);
+        reader.codec = static_cast<ColumnCodec>(header.codec);
+
+        // a block cut short by a crash is left out
+        size_t pos = sizeof(header), first = 0;
+        while (pos + sizeof(ColumnBlockHeader) <= reader.file.size()) {
+            ColumnBlockHeader b;
+            memcpy(&b, reader.file.data() + pos, sizeof(b));
+            pos += sizeof(b);
+            if (pos + b.bytes > reader.file.size()) break;
+            reader.blocks.push_back({b.count, b.min, b.max, pos, b.bytes, first});
+            pos += b.bytes;
+            first += b.count;
+        }
+        return reader;
+    }
+
+    std::vector<size_t> ColumnReader::blocks_overlapping(const double lo, const double hi) const {
+        std::vector<size_t> out;
+        for (size_t i = 0; i < blocks.size(); i++) {
+            if (blocks[i].max >= lo && blocks[i].min <= hi) {
+                out.push_back(i);
+            }
+        }
+        return out;
+    }
+
+    void ColumnReader::decode(const size_t block, std::vector<uint64_t> &bits) const {
+        const Block &b = blocks.at(block);
+        bits.reserve(bits.size() + b.count);
+        const uint8_t *p = file.data() + b.offset;
+        if (!decode_values(codec, ty, p, p + b.bytes, b.count, bits)) {
+            std::cerr << "ColumnReader: block " << block << " is corrupt\n";
+        }
+    }
+
+    std::vector<ColumnStore::BufferLayout> ColumnStore::describe(const Config &config) {
+        std::vector<BufferLayout> layout;
+        for (const auto &[name, entry]: config.get_entries()) {
+            const auto id = config.get_id_of(name);
+            if (!id) continue;
+            BufferLayout &l = layout.emplace_back();
+            l.name = name;
+            l.id = static_cast<uint8_t>(*id);
+            for (const auto &[field_name, field]: entry.get_fields()) {
+                l.fields.emplace_back(field_name, field);
+            }
+        }
+        return layout;
+    }
+
+    ColumnStore::ColumnStore(const std::vector<BufferLayout> &layout, const std::filesystem::path &directory) {
+        for (const BufferLayout &l: layout) {
+            std::error_code ec;
+            std::filesystem::create_directories(directory / l.name, ec);
+            if (ec) {
+                std::cerr << "ColumnStore: could not create " << directory / l.name << ": " << ec.message() << "\n";
+                continue;
+            }
+
+            Group &group = groups[l.id];
+            group.time = std::make_unique<ColumnWriter>(directory / (l.name + ".time.col"), Config::I64,
+                                                        ColumnCodec::DeltaOfDelta);
+            for (const auto &[field_name, field]: l.fields) {
+                group.fields.emplace_back(static_cast<uint32_t>(field.offset),
+                                          std::make_unique<ColumnWriter>(directory / l.name / (field_name + ".col"),
+                                                                         field.ty));
+            }
+        }
+    }
+
+    ColumnStore::~ColumnStore() {
+        seal_all();
+    }
+
+    void ColumnStore::append(const uint8_t type, const int64_t host_ns, const std::span<const uint8_t> data) {
+        const auto it = groups.find(type);
+        if (it == groups.end()) return;
+        Group &group = it->second;
+
+        if (group.time->pending() == 0) {
+            group.block_start_ns = host_ns;
+        } else if (host_ns - group.block_start_ns >= COLUMN_BLOCK_MAX_NS) {
+            // slow buffers would otherwise keep a block open for hours
+            seal(group);
+            group.block_start_ns = host_ns;
+        }
+
+        group.time->append(reinterpret_cast<const uint8_t *>(&host_ns));
+        for (const auto &[offset, column]: group.fields) {
+            column->append(data.data() + offset);
+        }
+
+        if (group.time->pending() == COLUMN_BLOCK_VALUES) {
+            seal(group);
+        }
+    }
+
+    void ColumnStore::seal(Group &group) {
+        group.time->seal();
+        for (const auto &column: group.fields | std::views::values) {
+            column->seal();
+        }
+    }
+
+    void ColumnStore::seal_all() {
+        for (Group &group: groups | std::views::values) {
+            seal(group);
+        }
+    }
+
+    std::optional<ColumnReader> ColumnStore::open_field(const std::filesystem::path &directory,
+                                                        const std::string &ident) {
+        const size_t dot = ident.find('.');
+        if (dot == std::string::npos) {
+            std::cerr << "ColumnStore: " << ident << " is not a field name\n";
+            return std::nullopt;
+        }
+        return ColumnReader::open(directory / ident.substr(0, dot) / (ident.substr(dot + 1) + ".col"));
+    }
+
+    std::optional<ColumnReader> ColumnStore::open_time(const std::filesystem::path &directory,
+                                                       const std::string &buffer) {
+        return ColumnReader::open(directory / (buffer + ".time.col"));
+    }
+} // DS
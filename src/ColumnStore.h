@@ -0,0 +1,255 @@
+/* date = October 17, 2026 8:50 PM */
+
+
+#ifndef COLUMNSTORE_H
+#define COLUMNSTORE_H
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Config.h"
+#include "MappedFile.h"
+
+/*
+ * Columnar session store.
+ *
+ * Every field of every buffer is kept in its own file, `<buffer>/<field>.col`, next to one `<buffer>.time.col`
+ * holding the host receive time (steady_clock nanoseconds) of each packet. A column file is a short header followed
+ * by blocks; each block starts with its value count, encoded size, and the smallest and largest value in it, so a
+ * reader can skip blocks without decoding them.
+ *
+ * All columns of one buffer get a value for every packet and seal their blocks together, so block `i` of the time
+ * column covers the same packets as block `i` of each field column. A time range therefore maps to the same block
+ * numbers in every column of the buffer.
+ *
+ * Codecs:
+ * - Delta: integers. Zig-zag LEB128 varints of the difference to the previous value.
+ * - DeltaOfDelta: timestamps. Varints of the change in difference, which is 0 for evenly spaced samples.
+ * - Xor: floats. Gorilla-style bit packing of the XOR with the previous value; repeated values take one bit.
+ */
+namespace DS {
+    // values per block, and the longest (in host time) a block stays open before it is written anyway
+    constexpr size_t COLUMN_BLOCK_VALUES = 4096;
+    constexpr int64_t COLUMN_BLOCK_MAX_NS = 60'000'000'000;
+
+    enum class ColumnCodec : uint8_t {
+        Delta,
+        DeltaOfDelta,
+        Xor,
+    };
+
+    struct ColumnBlockHeader {
+        uint32_t count;
+        // encoded bytes following the header
+        uint32_t bytes;
+        double min;
+        double max;
+    };
+
+    /**
+     * Builds one column file.
+     */
+    class ColumnWriter {
+    public:
+        /**
+         * @param path File to create.
+         * @param ty Type of the values, which also picks the codec.
+         * @param codec Codec to use, or std::nullopt for the default of `ty`.
+         */
+        ColumnWriter(const std::filesystem::path &path, Config::FieldType ty,
+                     std::optional<ColumnCodec> codec = std::nullopt);
+        ~ColumnWriter();
+
+        ColumnWriter(const ColumnWriter &) = delete;
+        ColumnWriter &operator=(const ColumnWriter &) = delete;
+
+        /**
+         * @param src A value of the column's type, in host byte order.
+         */
+        void append(const uint8_t *src);
+
+        /**
+         * Encodes and writes the values appended since the last block, if any.
+         */
+        void seal();
+
+        [[nodiscard]] size_t pending() const {
+            return values.size();
+        }
+
+        [[nodiscard]] bool is_open() const {
+            return file != nullptr;
+        }
+
+    private:
+        FILE *file = nullptr;
+        Config::FieldType ty;
+        ColumnCodec codec;
+        // raw bits of the open block's values, zero- or sign-extended to 64 bits
+        std::vector<uint64_t> values;
+        double min{}, max{};
+        std::vector<uint8_t> encoded;
+    };
+
+    /**
+     * Read-only view of one column file.
+     */
+    class ColumnReader {
+    public:
+        struct Block {
+            uint32_t count;
+            double min;
+            double max;
+            // offset of the encoded values in the file
+            size_t offset;
+            uint32_t bytes;
+            // values in all earlier blocks
+            size_t first;
+        };
+
+        /**
+         * Maps a column file and reads its block headers. Errors are printed.
+         */
+        static std::optional<ColumnReader> open(const std::filesystem::path &path);
+
+        [[nodiscard]] Config::FieldType get_type() const {
+            return ty;
+        }
+
+        [[nodiscard]] const std::vector<Block> &get_blocks() const {
+            return blocks;
+        }
+
+        /**
+         * @return Number of values in the column.
+         */
+        [[nodiscard]] size_t size() const {
+            return blocks.empty() ? 0 : blocks.back().first + blocks.back().count;
+        }
+
+        /**
+         * @return Numbers of the blocks that may hold a value in `[lo, hi]`, going only by block statistics.
+         */
+        [[nodiscard]] std::vector<size_t> blocks_overlapping(double lo, double hi) const;
+
+        /**
+         * Decodes one block.
+         * @tparam T Type to convert the values to.
+         * @param block Block number.
+         * @param out Values are appended here.
+         */
+        template<typename T>
+        void read_block(const size_t block, std::vector<T> &out) const {
+            std::vector<uint64_t> bits;
+            decode(block, bits);
+            constexpr uint8_t probe[sizeof(uint64_t)]{};
+            Config::visit_field(ty, probe, [&](auto tag) {
+                using V = decltype(tag);
+                for (const uint64_t b: bits) {
+                    V v;
+                    memcpy(&v, &b, sizeof(v));
+                    out.push_back(static_cast<T>(v));
+                }
+                return 0;
+            });
+        }
+
+        /**
+         * Decodes the whole column.
+         */
+        template<typename T>
+        [[nodiscard]] std::vector<T> read_all() const {
+            std::vector<T> out;
+            out.reserve(size());
+            for (size_t b = 0; b < blocks.size(); b++) {
+                read_block(b, out);
+            }
+            return out;
+        }
+
+    private:
+        explicit ColumnReader(MappedFile file) : file(std::move(file)) {
+        }
+
+        void decode(size_t block, std::vector<uint64_t> &bits) const;
+
+        MappedFile file;
+        Config::FieldType ty{};
+        ColumnCodec codec{};
+        std::vector<Block> blocks;
+    };
+
+    /**
+     * Writes the columns of every buffer of a config, one packet at a time.
+     */
+    class ColumnStore {
+    public:
+        /**
+         * What the store needs to know about one buffer, copied out of a Config so the store can be built on another
+         * thread.
+         */
+        struct BufferLayout {
+            std::string name;
+            uint8_t id;
+            std::vector<std::pair<std::string, Config::Field>> fields;
+        };
+
+        static std::vector<BufferLayout> describe(const Config &config);
+
+        /**
+         * Creates `directory` and one column file per field, plus a time column per buffer.
+         */
+        ColumnStore(const std::vector<BufferLayout> &layout, const std::filesystem::path &directory);
+        ~ColumnStore();
+
+        ColumnStore(const ColumnStore &) = delete;
+        ColumnStore &operator=(const ColumnStore &) = delete;
+
+        /**
+         * @param type Message id of the packet.
+         * @param host_ns Host receive time of the packet.
+         * @param data Entry bytes of the packet.
+         */
+        void append(uint8_t type, int64_t host_ns, std::span<const uint8_t> data);
+
+        /**
+         * Writes every open block.
+         */
+        void seal_all();
+
+        /**
+         * @param directory Store written by a ColumnStore.
+         * @param ident Field name in the format of "buffer.field".
+         */
+        static std::optional<ColumnReader> open_field(const std::filesystem::path &directory, const std::string &ident);
+
+        /**
+         * @param directory Store written by a ColumnStore.
+         * @param buffer Buffer name.
+         * @return Host receive times of the buffer's packets.
+         */
+        static std::optional<ColumnReader> open_time(const std::filesystem::path &directory, const std::string &buffer);
+
+    private:
+        struct Group {
+            std::unique_ptr<ColumnWriter> time;
+            // field offset and column, in name order
+            std::vector<std::pair<uint32_t, std::unique_ptr<ColumnWriter>>> fields;
+            int64_t block_start_ns = 0;
+        };
+
+        void seal(Group &group);
+
+        // by message id
+        std::map<uint8_t, Group> groups;
+    };
+} // DS
+
+#endif //COLUMNSTORE_H
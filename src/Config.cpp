@@ -5,6 +5,7 @@
 
 #include <iostream>
 #include <iosfwd>
+#include <ranges>
 
 #include "Graph.h"
 
@@ -24,18 +25,25 @@ namespace DS {
                 exit(-1);
             }
 
-            id_name_pairs[get_id(id).value()] = Entry{};
+            const auto name = static_cast<std::string>(key.str());
+            id_names[id] = name;
+            id_name_pairs[name] = Entry{};
 
-            std::cout << "Initializing key " << key << " to id #" << get_id(id).value() << ".\n";
-            populate_buffer(static_cast<std::string>(key.str()), val, id_name_pairs[get_id(id).value()]);
+            std::cout << "Initializing key " << key << " to id #" << id << ".\n";
+            populate_buffer(name, val, id_name_pairs[name]);
         });
 
+        for (auto &e: id_name_pairs | std::views::values) {
+            e.index = static_cast<uint32_t>(entry_buffers.size());
+            entry_buffers.push_back(e.back);
+        }
+
         config["graph"].as_table()->for_each([this](const toml::key &key, const toml::table &val) {
             const auto k = key.str();
 
             auto a = val["length"];
             auto b = a.as_floating_point();
-            float c = 20.0;
+            float c = DEFAULT_GRAPH_WIDTH;
             if (b) {
                 c = b->value_or<float>(0.0);
             }
@@ -46,12 +54,48 @@ namespace DS {
                 expr = toml_value->value_or("");
             }
 
-            graphs.emplace_back(
+            const auto capacity = val["capacity"].value_or<int64_t>(DEFAULT_GRAPH_CAPACITY);
+            if (capacity <= 0) {
+                std::cerr << "Invalid capacity " << capacity << " for graph " << key << "!\n";
+                exit(-1);
+            }
+
+            graphs.push_back(std::make_unique<Graph>(
                 k.data(),
                 expr,
-                c
-            );
+                c,
+                static_cast<size_t>(capacity)
+            ));
         });
+
+        for (const auto &g: graphs) {
+            g->bind(*this);
+        }
+    }
+
+    Config::Config(Config &&) noexcept = default;
+    Config &Config::operator=(Config &&) noexcept = default;
+    Config::~Config() = default;
+
+    std::optional<Config::FieldHandle> Config::resolve(const std::string &ident) const {
+        const size_t dot = ident.find('.');
+        if (dot == std::string::npos) {
+            return std::nullopt;
+        }
+        const auto entry = id_name_pairs.find(ident.substr(0, dot));
+        if (entry == id_name_pairs.end()) {
+            return std::nullopt;
+        }
+        const std::optional<Field> field = entry->second.get(ident.substr(dot + 1));
+        if (!field) {
+            return std::nullopt;
+        }
+        return FieldHandle{
+            static_cast<uint32_t>(std::distance(id_name_pairs.begin(), entry)),
+            static_cast<uint32_t>(field->offset),
+            static_cast<uint32_t>(field->size),
+            field->ty,
+        };
     }
 
     void Config::populate_buffer(const std::string &key, const toml::table &val, Entry &e) {
@@ -88,16 +132,15 @@ namespace DS {
             buffer_size += *size;
         });
 
-        e.back = new uint8_t[buffer_size];
+        e.back = std::make_shared<SeqlockBuffer>(buffer_size);
         e.size = buffer_size;
 
         // TODO: this is unnecessary debug.
         size_t offset = 0;
         for (const std::string &str: key_order) {
-            auto &[e_offset, size, data, ty] = e.name_idx_pairs[str];
+            auto &[e_offset, size, ty] = e.name_idx_pairs[str];
             e_offset = static_cast<long>(offset);
             offset += size;
-            data = reinterpret_cast<char *>(e.back) + e_offset;
             std::cout << key << "." << str << ": " << size << "@" << e_offset << "\n";
         }
     }
@@ -4,9 +4,15 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <span>
+#include <unordered_map>
 #include <toml++/toml.hpp>
 
+#include "Seqlock.h"
+
 namespace DS {
     class Graph;
 
@@ -44,7 +50,19 @@ namespace DS {
         struct Field {
             ptrdiff_t offset;
             ptrdiff_t size;
-            void *data;
+            FieldType ty;
+        };
+
+        /**
+         * A field resolved ahead of time from its "buffer.field" name, so reading it needs no lookups.
+         *
+         * Obtained from `Config::resolve` and only valid for the Config that produced it.
+         */
+        struct FieldHandle {
+            // index of the buffer in Config
+            uint32_t entry;
+            uint32_t offset;
+            uint32_t size;
             FieldType ty;
         };
 
@@ -52,6 +70,10 @@ namespace DS {
          * A buffer that an entire packet sent over telemetry can fit into.
          *
          * Each buffer is split up into Fields, much like how a class has fields.
+         *
+         * The latest values are published through a seqlock: the telemetry side calls `publish`, and any thread may
+         * read at any time and always sees the fields of a single packet. Copies of an Entry share the same live
+         * values.
          */
         class Entry {
         public:
@@ -69,11 +91,28 @@ namespace DS {
             }
 
             /**
-             * Get the pointer to the buffer as a `uint8_t *`.
-             * @return Raw pointer of buffer.
+             * Replace the live values of this buffer with a new packet.
+             * NOTE: only one thread may publish to a given buffer.
+             * @param src Packet data. Only the first `get_size()` bytes are used.
+             */
+            void publish(const std::span<const uint8_t> src) const {
+                back->publish(src);
+            }
+
+            /**
+             * Copy a consistent snapshot of the whole buffer.
+             * @param dst Destination, at least `get_size()` bytes.
+             * @return Generation of the snapshot (number of packets published before it).
+             */
+            uint64_t read(const std::span<uint8_t> dst) const {
+                return back->read(0, dst.first(size));
+            }
+
+            /**
+             * @return Number of packets published to this buffer so far.
              */
-            uint8_t *as_ptr() const {
-                return back;
+            [[nodiscard]] uint64_t generation() const {
+                return back->generation();
             }
 
             /**
@@ -96,16 +135,27 @@ namespace DS {
                 if (!f.has_value()) {
                     return std::nullopt;
                 }
-                return std::optional(*static_cast<T *>(f.value().data));
+                T ret{};
+                const size_t n = std::min(sizeof(T), static_cast<size_t>(f->size));
+                back->read(f->offset, {reinterpret_cast<uint8_t *>(&ret), n});
+                return ret;
             }
 
-            std::map<std::string, Field> get_fields() {
+            const std::map<std::string, Field> &get_fields() const {
                 return name_idx_pairs;
             }
 
+            /**
+             * @return Position of this buffer in the config, as used by `FieldHandle::entry`.
+             */
+            [[nodiscard]] uint32_t get_index() const {
+                return index;
+            }
+
         private:
-            uint8_t *back{};
+            std::shared_ptr<SeqlockBuffer> back;
             size_t size{};
+            uint32_t index{};
             std::map<std::string, Field> name_idx_pairs;
 
             friend class Config;
@@ -119,7 +169,14 @@ namespace DS {
          */
         explicit Config(const std::string &filepath);
 
-        ~Config() = default;
+        // graphs hold handles into this config, so it can only be moved
+        Config(const Config &) = delete;
+        Config &operator=(const Config &) = delete;
+        // defined with Graph complete, in Config.cpp
+        Config(Config &&) noexcept;
+        Config &operator=(Config &&) noexcept;
+
+        ~Config();
 
 
         /**
@@ -147,20 +204,87 @@ namespace DS {
         }
 
         [[nodiscard]] std::optional<std::string> get_id(const size_t id) const {
-            for (auto &[first, second]: *config["ds"].as_table()) {
-                const auto buffer_table = second.as_table();
-                if (!buffer_table)
-                    continue;
-                const auto field_value = buffer_table->get("id");
-                if (!field_value)
-                    continue;
-                if (field_value->value<size_t>() == id) {
-                    return std::string(first);
-                }
+            const auto it = id_names.find(id);
+            if (it == id_names.end()) {
+                return std::nullopt;
+            }
+            return it->second;
+        }
+
+        /**
+         * Finds a buffer by the message id it is sent with.
+         * @param id Message id as set in the config file.
+         * @return The buffer for that id, or nullptr if no buffer uses it.
+         */
+        [[nodiscard]] const Entry *get_by_id(const size_t id) const {
+            const auto it = id_names.find(id);
+            if (it == id_names.end()) {
+                return nullptr;
+            }
+            return get(it->second);
+        }
+
+        /**
+         * Reverse of `get_id`.
+         * @param name Buffer name.
+         * @return The message id the buffer is sent with, or std::nullopt if there is no such buffer.
+         */
+        [[nodiscard]] std::optional<size_t> get_id_of(const std::string &name) const {
+            for (const auto &[id, n]: id_names) {
+                if (n == name) return id;
             }
             return std::nullopt;
         }
 
+        /**
+         * @return Every buffer by name. Iteration order matches `Entry::get_index`.
+         */
+        [[nodiscard]] const std::map<std::string, Entry> &get_entries() const {
+            return id_name_pairs;
+        }
+
+        /**
+         * Resolves an identifier of the form "{buffer_name}.{field_name}" once, for repeated cheap reads.
+         * @param ident Dotted field identifier.
+         * @return Handle for the field, or std::nullopt if the buffer or field doesn't exist.
+         */
+        [[nodiscard]] std::optional<FieldHandle> resolve(const std::string &ident) const;
+
+        /**
+         * Calls `f` with the value at `src` interpreted as the C++ type matching `ty`.
+         * @param ty Type of the field.
+         * @param src Raw bytes of the field, as laid out in the packet.
+         * @param f Callable accepting every field type.
+         * @return Whatever `f` returns.
+         */
+        template<typename F>
+        static auto visit_field(const FieldType ty, const uint8_t *src, F &&f) {
+            switch (ty) {
+                case I8: return f(load<int8_t>(src));
+                case I16: return f(load<int16_t>(src));
+                case I32: return f(load<int32_t>(src));
+                case I64: return f(load<int64_t>(src));
+                case U8: return f(load<uint8_t>(src));
+                case U16: return f(load<uint16_t>(src));
+                case U32: return f(load<uint32_t>(src));
+                case U64: return f(load<uint64_t>(src));
+                case F32: return f(load<float>(src));
+                case F64: break;
+            }
+            return f(load<double>(src));
+        }
+
+        /**
+         * Reads the latest value of a field, converted to double.
+         * @param h Handle from `resolve` on this config.
+         * @return Value of the field.
+         */
+        [[nodiscard]] double read(const FieldHandle &h) const {
+            uint8_t raw[sizeof(uint64_t)]{};
+            entry_buffers[h.entry]->read(h.offset, {raw, h.size});
+            return visit_field(h.ty, raw, [](auto v) { return static_cast<double>(v); });
+        }
+
         Entry &operator[](const std::string &id) {
             Entry *e = get(id);
             if (e) return *e;
@@ -175,6 +299,13 @@ namespace DS {
             exit(-1);
         }
 
+        /**
+         * @return The whole parsed config file, for settings outside the tables this class reads.
+         */
+        [[nodiscard]] const toml::table &get_table() const {
+            return config;
+        }
+
         /**
          * Match a typename as found in config file with a size in bytes for the type.
          *
@@ -188,6 +319,13 @@ namespace DS {
         // Helper function for generating buffers
         static void populate_buffer(const std::string &key, const toml::table &val, Entry &e);
 
+        template<typename T>
+        static T load(const uint8_t *src) {
+            T v;
+            memcpy(&v, src, sizeof(v));
+            return v;
+        }
+
         static std::optional<const char *>field_type_to_str(const FieldType f) {
             switch (f) {
                 case I8:
@@ -244,12 +382,17 @@ namespace DS {
         toml::table config;
         // packet management
         std::map<std::string, Entry> id_name_pairs;
+        // message id -> buffer name
+        std::unordered_map<size_t, std::string> id_names;
+        // live values of each buffer, indexed by FieldHandle::entry (buffer names in sorted order)
+        std::vector<std::shared_ptr<SeqlockBuffer>> entry_buffers;
         // output management
         std::string output_path;
         bool output_enabled = false;
 
         // graph management
-        std::vector<Graph> graphs;
+        // graphs are heap-allocated so adding one never moves the others
+        std::vector<std::unique_ptr<Graph>> graphs;
 
         friend class Dashboard;
     };
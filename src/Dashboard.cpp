@@ -3,16 +3,25 @@
 
 #include "Dashboard.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <filesystem>
 #include <iostream>
+#include <type_traits>
 
 #include "Graph.h"
 #include "Window.h"
 
 namespace DS {
-    Dashboard::Dashboard() {
+    // where the entry bytes start in `BufferParser::Buffer::data`
+    static constexpr size_t ENTRY_DATA_OFFSET = 4;
+    static_assert(ENTRY_DATA_OFFSET + MSG_LENGTH <= BUFFER_LENGTH);
+
+    Dashboard::Dashboard(const bool headless) : headless(headless) {
         start_time = std::chrono::system_clock::now();
-        window = new Window(this);
+        if (!headless) {
+            window = new Window(this);
+        }
     }
 
     Dashboard::~Dashboard() {
@@ -29,8 +38,8 @@ namespace DS {
     }
 
     void Dashboard::update_plots() {
-        for (auto &g : this->config->graphs) {
-            g.update(*this, (std::chrono::system_clock::now() - start_time).count() / 1e9);
+        for (const auto &g : this->config->graphs) {
+            g->update(*this->config, elapsed());
         }
         // pseudocode:
         // for each graph, evaluate them with new collected data
@@ -40,85 +49,162 @@ namespace DS {
     }
 
     void Dashboard::consume(const BufferParser::Buffer &buffer) {
-        constexpr size_t DATA_OFFSET = 4;
         // TODO: semantics of dropped packet...
         if (!this->config.has_value()) return;
-        const auto *entry = this->config->get(id_name(buffer.type));
+        const auto *entry = this->config->get_by_id(buffer.type);
         if (!entry) {
             std::cerr << "Undefined message found! Unknown id: " << static_cast<uint32_t>(buffer.type) << "\n";
             return;
         }
-        memcpy(entry->as_ptr(), &buffer.data[DATA_OFFSET], entry->get_size());
+        const auto packet = std::span(buffer.data).subspan(ENTRY_DATA_OFFSET);
+        entry->publish(packet);
+        if (this->field_history.has_value()) {
+            this->field_history->append(entry->get_index(), elapsed(), packet);
+        }
+        const auto value = [&](const Config::FieldHandle &h) {
+            return Config::visit_field(h.ty, packet.data() + h.offset, [](auto v) {
+                return static_cast<double>(v);
+            });
+        };
+        if (this->gps_latitude.has_value() && entry->get_index() == this->gps_latitude->entry) {
+            this->gps_track.add(value(*this->gps_latitude), value(*this->gps_longitude));
+        }
+        if (this->uplink_ack.has_value() && entry->get_index() == this->uplink_ack->entry) {
+            // read as an integer: `set_config` only keeps unsigned fields, and a double can't hold every u64
+            const uint64_t sequence = Config::visit_field(this->uplink_ack->ty,
+                                                          packet.data() + this->uplink_ack->offset, [](auto v) {
+                if constexpr (std::is_integral_v<decltype(v)>) {
+                    return static_cast<uint64_t>(v);
+                } else {
+                    return uint64_t{0};
+                }
+            });
+            this->uplink.acknowledge(static_cast<uint32_t>(sequence));
+        }
+    }
+
+    bool Dashboard::push_packet(const BufferParser::Buffer &buffer) {
+        // logged here rather than in `consume` so rows don't depend on the UI keeping up
+        Logger::Record record{};
+        record.type = static_cast<uint8_t>(buffer.type);
+        record.car_timestamp = buffer.timestamp;
+        record.host_monotonic_ns = buffer.received_ns;
+        record.unix_time = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::copy_n(buffer.data + ENTRY_DATA_OFFSET, MSG_LENGTH, record.data);
+        this->logger.log(record);
+
+        if (this->headless) {
+            // the telemetry thread is the only consumer, so the same rules hold as for `update`
+            consume(buffer);
+            return true;
+        }
+        return packets.push(buffer);
     }
 
     void Dashboard::update() {
         window->update();
 
-        if (write_lock.try_lock()) {
-            if (this->config.has_value()) {
-                update_plots();
-                for (auto entries : this->config->id_name_pairs) {
-                    // needed due to const qualification
-                    std::string name = entries.first;
-                    dump_entry(name, entries.second);
-                }
-            }
-            write_lock.unlock();
+        // consume runs on this thread only, so config and entries need no lock
+        packets.drain([this](const BufferParser::Buffer &buffer) {
+            consume(buffer);
+        });
+
+        if (this->config.has_value()) {
+            update_plots();
         }
 
-        this->closing = window->should_close();
+        if (window->should_close()) {
+            request_close();
+        }
 
         auto time = std::chrono::system_clock::now();
         this->dt = static_cast<double>((time - prev_time).count()) / 1e9;
 
         if (static_cast<double>((time - this->second_mark).count()) >= 1e9) {
             this->second_mark = time;
-            this->bitrate = this->bytes_read * 8;
-            this->bytes_read = 0;
+            this->bitrate = this->bytes_read.exchange(0, std::memory_order_relaxed) * 8;
         }
         prev_time = time;
     }
 
     void Dashboard::send_strategy(float target_soc, int target_unix_time, uint32_t target_interval) {
-        // data format for telemetry:
-        // header (4 bytes): "GCS " (space)
+        // command body, sent in a "GCS " frame (see Uplink.h):
         // target_soc (4 bytes) target_unix_time (4 bytes) target_interval (4 bytes)
-        // footer (4 bytes): "UKSC"
-        // padding (20 bytes)
-        // RS-FEC (12 bytes)
-        // total: 52 bytes
-        uint8_t data[40];
-        uint8_t encoded[52];
+        uint8_t body[UPLINK_BODY_LENGTH];
         int offset = 0;
 
-        memcpy(data + offset, "GCS ", 4);
-        offset += 4;
-        memcpy(data + offset, &target_soc, sizeof(target_soc));
+        memcpy(body + offset, &target_soc, sizeof(target_soc));
         offset += sizeof(target_soc);
-        memcpy(data + offset, &target_unix_time, sizeof(target_unix_time));
+        memcpy(body + offset, &target_unix_time, sizeof(target_unix_time));
         offset += sizeof(target_unix_time);
-        memcpy(data + offset, &target_interval, sizeof(target_interval));
-        offset += sizeof(target_interval);
-
-        memcpy(data + offset, "UKSC", 4);
-        offset += 4;
-        memset(data + offset, 0, 40 - offset);
-        //offset = 40;
+        memcpy(body + offset, &target_interval, sizeof(target_interval));
 
-        rs.Encode(data, encoded);
-
-        serial->put_bytes(reinterpret_cast<const char *>(encoded), BUFFER_LENGTH);
+        char label[96];
+        snprintf(label, sizeof(label), "Strategy: SoC %.4f, time %d, interval %u", target_soc, target_unix_time,
+                 target_interval);
+        this->uplink.send(label, body);
     }
 
     void Dashboard::set_config(const std::string &path) {
         if (std::filesystem::exists(path)) {
             this->config = Config(path);
-            this->init_csv_storage();
+            this->logger.open(*this->config, get_csv_storage_path());
+
+            // headless there are no graphs or map to fill, so packets only go to the logger
+            this->field_history = std::nullopt;
+            this->gps_latitude = this->gps_longitude = std::nullopt;
+            if (!this->headless) {
+                this->field_history.emplace(*this->config);
+                this->gps_latitude = this->config->resolve("gps.latitude");
+                this->gps_longitude = this->config->resolve("gps.longitude");
+                if (!this->gps_latitude || !this->gps_longitude ||
+                    this->gps_latitude->entry != this->gps_longitude->entry) {
+                    this->gps_latitude = this->gps_longitude = std::nullopt;
+                }
+            }
+
+            this->uplink_ack = std::nullopt;
+            if (const auto ack = this->config->get_table()["uplink"]["ack"].value<std::string>()) {
+                this->uplink_ack = this->config->resolve(*ack);
+                if (!this->uplink_ack) {
+                    std::cerr << "Uplink: ack field \"" << *ack << "\" not found, commands won't be retried\n";
+                } else if (this->uplink_ack->ty != Config::U32 && this->uplink_ack->ty != Config::U64) {
+                    // a narrower field wraps before the sequence number does, and a signed or float one can't hold it
+                    std::cerr << "Uplink: ack field \"" << *ack
+                              << "\" must be a u32 or u64 to hold the sequence number, commands won't be retried\n";
+                    this->uplink_ack = std::nullopt;
+                }
+            }
+            this->uplink.set_ack_tracking(this->uplink_ack.has_value());
         }
         else {
             this->config = std::nullopt;
+            this->field_history = std::nullopt;
+            this->logger.close();
+            this->gps_latitude = this->gps_longitude = std::nullopt;
+            this->uplink_ack = std::nullopt;
+            this->uplink.set_ack_tracking(false);
         }
     }
+
+    void Dashboard::set_graph(const std::string &name, const std::string &formula) {
+        if (!this->config.has_value()) return;
+
+        auto g = std::make_unique<Graph>(name, formula, DEFAULT_GRAPH_WIDTH);
+        g->bind(*this->config);
+        if (this->field_history.has_value()) {
+            g->backfill(*this->field_history);
+        }
+
+        for (auto &existing: this->config->graphs) {
+            if (name == existing->get_name()) {
+                existing = std::move(g);
+                return;
+            }
+        }
+        this->config->graphs.push_back(std::move(g));
+    }
     
     std::optional<std::string> Dashboard::get_config_path() {
         if (this->config.has_value()) {
@@ -136,10 +222,7 @@ namespace DS {
     }
 
     bool Dashboard::has_key(const std::string &ident) const {
-        // TODO: what if ident doesn't have '.'?
-        const auto buffer_name = ident.substr(0, ident.find('.'));
-        const auto field_name = ident.substr(ident.find('.')+1);
-        return (*this->config)[buffer_name].get_value<void *>(field_name).has_value();
+        return this->config.has_value() && this->config->resolve(ident).has_value();
     }
 
     static std::optional<uint32_t> init_timestamp = std::nullopt;
@@ -156,75 +239,10 @@ namespace DS {
             ).count();
         }
 
+        // created by the logger thread when it opens its files
         storage_path /= std::to_string(*init_timestamp);
-        std::filesystem::create_directories(storage_path);
 
         return storage_path;
 
     }
-    void Dashboard::init_csv_storage() {
-        for (auto id_name_pair : config->id_name_pairs) {
-            std::string filename = id_name_pair.first + ".csv";
-            std::vector<std::string> headers;
-
-            std::filesystem::path p{filename};
-            std::ofstream out{get_csv_storage_path() / p};
-
-            int field_counter = 0;
-            for (auto name_idx_pairs : id_name_pair.second.get_fields()) {
-                out << name_idx_pairs.first;
-
-                field_counter++;
-                if (field_counter <= id_name_pair.second.get_fields().size()) {
-                    out << ',';
-                }
-            }
-            out << "unix_timestamp";
-            out << std::endl;
-
-            out.close();
-        }
-    }
-
-    void dump_field(std::ofstream &out, std::string &name, Config::Entry &e) {
-        switch (e.get(name)->ty) {
-            case Config::I8: out << *e.get_value<int8_t>(name); break;
-            case Config::I16: out << *e.get_value<int16_t>(name); break;
-            case Config::I32: out << *e.get_value<int32_t>(name); break;
-            case Config::I64: out << *e.get_value<int64_t>(name); break;
-            case Config::U8: out << *e.get_value<uint8_t>(name); break;
-            case Config::U16: out << *e.get_value<uint16_t>(name); break;
-            case Config::U32: out << *e.get_value<uint32_t>(name); break;
-            case Config::U64: out << *e.get_value<uint64_t>(name); break;
-            case Config::F32: out << *e.get_value<float>(name); break;
-            case Config::F64: out << *e.get_value<double>(name); break;
-            default: break;
-        }
-    }
-
-    void Dashboard::dump_entry(std::string &name, Config::Entry &e) {
-        std::string filename = name + ".csv";
-        std::vector<std::string> headers;
-
-        std::filesystem::path p{filename};
-
-        std::ofstream out{get_csv_storage_path() / p, std::ios_base::app};
-
-        int field_counter = 0;
-        for (auto name_idx_pairs : e.get_fields()) {
-            std::string s = name_idx_pairs.first;
-            dump_field(out, s, e);
-
-            field_counter++;
-            if (field_counter <= e.get_fields().size()) {
-                out << ',';
-            }
-        }
-        out << std::chrono::duration_cast<std::chrono::seconds>(
-                   std::chrono::system_clock::now().time_since_epoch())
-                   .count();
-        out << std::endl;
-
-        out.close();
-    }
 } // DS
@@ -4,13 +4,19 @@
 #ifndef DASHBOARD_H
 #define DASHBOARD_H
 
+#include <atomic>
 #include <chrono>
 #include <filesystem>
-#include <mutex>
 #include <vector>
 
 #include "BufferParser.h"
+#include "Capture.h"
+#include "FieldHistory.h"
+#include "GpsTrack.h"
 #include "IOSerial.h"
+#include "Logger.h"
+#include "SPSCQueue.h"
+#include "Uplink.h"
 #include "Window.h"
 #include "common.h"
 
@@ -25,8 +31,10 @@ public:
     /**
      * This constructor initializes an empty window. Most of the graphics initialization is handled
      * in Window's constructor.
+     * @param headless If true, no window (or GL context) is created. Packets are then consumed on the telemetry
+     * thread as they arrive, and `update` must not be called.
      */
-    Dashboard();
+    explicit Dashboard(bool headless = false);
     ~Dashboard();
 
     /**
@@ -57,9 +65,19 @@ public:
      */
     void consume(const BufferParser::Buffer &buffer);
 
+    /**
+     * Hands a finished packet from the telemetry thread to the UI thread, and queues its log row. Never blocks; if the
+     * UI has fallen too far behind the packet is dropped and counted, but it is still logged. When headless there is
+     * no UI thread, so the packet is consumed right here.
+     * NOTE: only the telemetry thread may call this.
+     * @param buffer buffer from BufferParser class to queue.
+     * @return false if the packet was dropped.
+     */
+    bool push_packet(const BufferParser::Buffer &buffer);
+
     // Note: used by main function for tracking bitrate of data received by DeltaStation.
-    void byte_increment() {
-        this->bytes_read++;
+    void byte_increment(const uint32_t count = 1) {
+        this->bytes_read.fetch_add(count, std::memory_order_relaxed);
     }
 
     /**
@@ -68,7 +86,26 @@ public:
      * @return If window is closing.
      */
     [[nodiscard]] bool should_close() const {
-        return closing;
+        return closing.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Asks every loop to stop, and wakes `wait_for_close`. Safe to call from any thread.
+     */
+    void request_close() {
+        closing.store(true, std::memory_order_release);
+        closing.notify_all();
+    }
+
+    /**
+     * Blocks until `request_close` is called.
+     */
+    void wait_for_close() const {
+        closing.wait(false, std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool is_headless() const {
+        return headless;
     }
 
     void update();
@@ -76,6 +113,14 @@ public:
     void send_strategy(float target_soc, int target_unix_time, uint32_t uint32);
 
     void set_config(const std::string &path);
+
+    /**
+     * Adds a graph, or replaces the formula of the graph with the same name, and fills it in (in the background)
+     * with the last FIELD_HISTORY_ROWS packets of every buffer it reads.
+     * @param name Graph name, shown as its window title.
+     * @param formula Expression over "{buffer_name}.{field_name}" identifiers.
+     */
+    void set_graph(const std::string &name, const std::string &formula);
     std::optional<std::string> get_config_path();
 
     void debug_print_packet_ids();
@@ -87,6 +132,7 @@ public:
         // Every identity MUST be of the form "{buffer_name}.{field_name}"
         const std::string buffer_name = ident.substr(0, ident.find('.'));
         const std::string field_name = ident.substr(ident.find('.')+1);
+        if (!this->config.has_value()) return std::nullopt;
         const Config::Entry *entry = this->config->get(buffer_name);
 
         if (!entry) return std::nullopt;
@@ -97,10 +143,7 @@ public:
             if (!tn) return std::nullopt;
 
             if (type_str<T>() == *tn) {
-                // mem transmute!
-                T ret;
-                memcpy(&ret, field->data, sizeof(ret));
-                return ret;
+                return entry->get_value<T>(field_name);
             }
         }
 
@@ -118,32 +161,24 @@ public:
             memset(&ret, 0, sizeof(ret));
             return ret;
         }
-        const std::optional<Config::Field> field = entry->get(field_name);
-        if (field.has_value()) {
-            T ret;
-            memcpy(&ret, field->data, sizeof(ret));
-            return ret;
+        const std::optional<T> value = entry->get_value<T>(field_name);
+        if (value.has_value()) {
+            return *value;
         }
         T ret;
         memset(&ret, 0, sizeof(ret));
         return ret;
     }
 
-    [[nodiscard]] bool try_lock() {
-        return write_lock.try_lock();
-    }
-    void lock() {
-        write_lock.lock();
-    }
-    void unlock() {
-        write_lock.unlock();
-    }
-
     IOSerial *serial{};
+    // only read from, for displaying FEC statistics.
+    const BufferParser *parser{};
+    // only read from, for displaying dropped capture bytes; null when not capturing.
+    const Capture *capture{};
+    // sends commands to the car over `serial`; opened once `serial` is set
+    Uplink uplink;
 
     std::filesystem::path get_csv_storage_path();
-    void init_csv_storage();
-    void dump_entry(std::string &name, Config::Entry &e);
 
     /**
      * Currently, this is only used to modify which directory we store csv out
@@ -155,7 +190,7 @@ public:
 
 private:
     // TODO: this is dangerous! what if config is uninitialized???
-    std::vector<Graph> &get_graphs() {
+    std::vector<std::unique_ptr<Graph>> &get_graphs() {
         return config->graphs;
     }
 
@@ -193,26 +228,44 @@ private:
         }
     }
 
+    // seconds since start_time; the x axis of every graph
+    [[nodiscard]] double elapsed() const {
+        return static_cast<double>((std::chrono::system_clock::now() - start_time).count()) / 1e9;
+    }
+
     // time-keeping
     std::chrono::system_clock::time_point start_time;
     std::chrono::system_clock::time_point prev_time;
     std::chrono::system_clock::time_point second_mark;
     double dt{};
 
-    // bitrate
-    uint32_t bytes_read{};
+    // bitrate (bytes_read is bumped by the telemetry thread)
+    std::atomic<uint32_t> bytes_read{};
     uint32_t bitrate{};
 
     // window management
     Window *window = nullptr;
-    bool closing = false;
-
-    // TODO: we have a duplicate RS encoder in BufferParser.h. Consider using that one??
-    RS::ReedSolomon<MSG_LENGTH, ECC_LENGTH> rs{};
+    std::atomic<bool> closing{false};
+    bool headless = false;
 
     std::optional<Config> config;
-
-    std::mutex write_lock;
+    // CSV output, one row per packet; fed by the telemetry thread, all file I/O happens on its own thread
+    Logger logger;
+
+    // every packet consumed since the config was loaded, for graph backfill; never kept when headless
+    std::optional<FieldHistory> field_history;
+
+    // every GPS fix since startup, drawn on the map; kept when the config is reloaded
+    GpsTrack gps_track;
+    // where consume finds the fixes: "gps.latitude" and "gps.longitude", if the config has both in one buffer (and
+    // there is a map to draw them on)
+    std::optional<Config::FieldHandle> gps_latitude;
+    std::optional<Config::FieldHandle> gps_longitude;
+    // the field named by `ack` in the config's [uplink] table, where the car echoes the last command it received
+    std::optional<Config::FieldHandle> uplink_ack;
+
+    // filled by the telemetry thread, drained (and consumed) once per frame in `update`
+    SPSCQueue<BufferParser::Buffer, PACKET_QUEUE_CAPACITY> packets;
 
     bool debug_mode = false;
 
@@ -4,69 +4,72 @@
 #include "DebugReader.h"
 
 #include <climits>
+#include <cstring>
 #include <ctime>
 #include <iomanip>
 #include <thread>
 
 namespace DS {
-    static float CURR_RAND_V = 0.0;
-    static float CURR_RAND_C = 0.0;
-    static float CURR_RAND_SPEED = 0.0;
-    static int CURR_UNIX_TIME = 0;
+    static float random_reading() {
+        return static_cast<float>(rand()) / static_cast<float>(INT_MAX / 10);
+    }
+
+    void DebugReader::build_frame() {
+        uint8_t msg[MSG_LENGTH];
+        memcpy(msg, SAMPLE_BUFFER, MSG_LENGTH);
+
+        msg[MESSAGE_TYPE_BYTE] = message_type;
+        message_type = message_type == 1 ? 2 : 1;
+
+        const int unix_time = static_cast<int>(std::time(nullptr));
+        const float voltage = random_reading();
+        const float current = random_reading();
+        const float speed = random_reading();
+        memcpy(&msg[TIME_OFFSET], &unix_time, sizeof(unix_time));
+        memcpy(&msg[DATA_OFFSET], &voltage, sizeof(voltage));
+        memcpy(&msg[DATA_OFFSET + 4], &current, sizeof(current));
+        memcpy(&msg[DATA_OFFSET + 8], &speed, sizeof(speed));
+
+        rs.Encode(msg, frame);
+    }
 
     uint8_t DebugReader::get_byte() {
-        if (position == 10) {
-            CURR_RAND_V = static_cast<float>(rand()) / static_cast<float>(INT_MAX / 10);
-        }
-        if (position == 14) {
-            CURR_RAND_C = static_cast<float>(rand()) / static_cast<float>(INT_MAX / 10);
-        }
-        if (position == 6) {
-            CURR_UNIX_TIME = std::time(nullptr);
-        }
-        if (position == 18) {
-            CURR_RAND_SPEED = static_cast<float>(rand()) / static_cast<float>(INT_MAX / 10);
-        }
-        // note to future reader: JetBrains editors recommend making as many
-        // variables const as possible. This is likely an influence from
-        // languages like Rust, where variables are immutable by default. In
-        // this context, there is little consequence for having it mutable vs.
-        // immutable.
-        char b = 0;
-        if (position < 4)
-            b = "UKSC"[position];
-        else if (position == 10 || position == 11 || position == 12 || position == 13) {
-            b = reinterpret_cast<char *>(&CURR_RAND_V)[position - 10];
-        } else if (position == 14 || position == 15 || position == 16 || position == 17) {
-            b = reinterpret_cast<char *>(&CURR_RAND_C)[position - 14];
-        } else if (position == 18 || position == 19 || position == 20 || position == 21) {
-            b = reinterpret_cast<char *>(&CURR_RAND_SPEED)[position - 18];
-        } else if (position == 4) {
-            b = message_type;
-            message_type = message_type == 1 ? 2 : 1;
-        } else if (position == 6 || position == 7 || position == 8 || position == 9) {
-            b = reinterpret_cast<char *>(&CURR_UNIX_TIME)[position - 6];
-        } else {
-            b = SAMPLE_BUFFER[position];
+        if (position == 0) {
+            build_frame();
         }
+
+        const uint8_t b = frame[position];
         position++;
 
-        if (position >= sizeof(SAMPLE_BUFFER)) {
+        if (position >= sizeof(frame)) {
             position = 0;
             std::this_thread::sleep_for(std::chrono::microseconds(4000));
         }
         return b;
     }
 
-    void DebugReader::put(const std::string &s) {
+    int DebugReader::read_bytes(std::span<uint8_t> out, unsigned int timeout_ms) {
+        (void) timeout_ms;
+        size_t count = 0;
+        while (count < out.size()) {
+            out[count++] = get_byte();
+            // `get_byte` wraps `position` back to zero once a frame is complete.
+            if (position == 0) break;
+        }
+        return static_cast<int>(count);
+    }
+
+    bool DebugReader::put(const std::string &s) {
         std::cout << s;
+        return true;
     }
 
-    void DebugReader::put_byte(const char c) {
+    bool DebugReader::put_byte(const char c) {
         std::cout << c;
+        return true;
     }
 
-    void DebugReader::put_bytes(const char *buf, int len) {
+    bool DebugReader::put_bytes(const char *buf, int len) {
         int i = 0;
 
         std::cout << "{\n";
@@ -78,6 +81,8 @@ namespace DS {
             }
             std::cout << '\n';
         }
-        std::cout << "}\n";
+        // back to decimal, since other threads print to std::cout too
+        std::cout << "}\n" << std::dec << std::setfill(' ');
+        return true;
     }
 } // DS
@@ -6,6 +6,7 @@
 #include <cstdint>
 
 #include "IOSerial.h"
+#include "RS-FEC.h"
 #include "common.h"
 
 namespace DS {
@@ -23,27 +24,38 @@ public:
     // returns a byte with predefined layout and contents.
     uint8_t get_byte() override;
 
+    // fills `out` with the rest of the current frame. never hands out more than one frame per
+    // call, so the pacing done in `get_byte` still applies.
+    int read_bytes(std::span<uint8_t> out, unsigned int timeout_ms) override;
+
     // prints a string to std::cout
-    void put(const std::string &s) override;
+    bool put(const std::string &s) override;
 
     // prints a char to std::cout
-    void put_byte(char c) override;
+    bool put_byte(char c) override;
 
     // prints a formatted buffer to std::cout
-    void put_bytes(const char *buf, int len) override;
+    bool put_bytes(const char *buf, int len) override;
 
 private:
+    // fills `frame` with the next packet, RS-FEC encoded like the car's radio does it.
+    void build_frame();
+
     int position = 0;
     char message_type = 1;
-    static constexpr char SAMPLE_BUFFER[52] = {
+    static constexpr char SAMPLE_BUFFER[MSG_LENGTH] = {
         'U', 'K', 'S', 'C', // header
         0, // message type (overridden)
         0, // message length (to be used later in advanced error checking)
         0, 0, 0, 0, // timestamp (manually updated)
         0, 0, 0, 0, // voltage placeholder (randomized)
         0, 0, 0, 0, // current placeholder (randomized)
+        0, 0, 0, 0, // speed placeholder (randomized)
         'G', 'D', 'S'
     };
+
+    uint8_t frame[BUFFER_LENGTH]{};
+    RS::ReedSolomon<MSG_LENGTH, ECC_LENGTH> rs{};
 };
 
 } // DS
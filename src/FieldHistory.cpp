@@ -0,0 +1,138 @@
+/* date = October 17, 2026 4:15 PM */
+
+
+#include "FieldHistory.h"
+
+#include <algorithm>
+#include <limits>
+#include <ranges>
+
+#include "common.h"
+
+namespace DS {
+    // rows dropped at once when a buffer goes over FIELD_HISTORY_ROWS, so the columns are only shifted now and then
+    static constexpr size_t FIELD_HISTORY_TRIM = FIELD_HISTORY_ROWS / 8;
+
+    FieldHistory::FieldHistory(const Config &config) {
+        for (const auto &entry: config.get_entries() | std::views::values) {
+            if (tables.size() <= entry.get_index()) {
+                tables.resize(entry.get_index() + 1);
+            }
+            Table &table = tables[entry.get_index()];
+            table.size = entry.get_size();
+            for (const auto &field: entry.get_fields() | std::views::values) {
+                table.columns.push_back({static_cast<uint32_t>(field.offset), field.ty, {}});
+            }
+        }
+    }
+
+    void FieldHistory::append(const uint32_t entry, const double t, const std::span<const uint8_t> packet) {
+        if (entry >= tables.size()) return;
+        Table &table = tables[entry];
+        if (packet.size() < table.size) return;
+
+        if (table.times.size() >= FIELD_HISTORY_ROWS + FIELD_HISTORY_TRIM) {
+            table.times.erase(table.times.begin(), table.times.begin() + FIELD_HISTORY_TRIM);
+            for (Column &c: table.columns) {
+                c.values.erase(c.values.begin(), c.values.begin() + FIELD_HISTORY_TRIM);
+            }
+        }
+        table.times.push_back(t);
+        for (Column &c: table.columns) {
+            c.values.push_back(Config::visit_field(c.ty, packet.data() + c.offset, [](auto v) {
+                return static_cast<double>(v);
+            }));
+        }
+    }
+
+    std::span<const double> FieldHistory::times(const uint32_t entry) const {
+        if (entry >= tables.size()) return {};
+        return tables[entry].times;
+    }
+
+    const FieldHistory::Column *FieldHistory::find(const Config::FieldHandle &h) const {
+        if (h.entry >= tables.size()) return nullptr;
+        for (const Column &c: tables[h.entry].columns) {
+            if (c.offset == h.offset) return &c;
+        }
+        return nullptr;
+    }
+
+    std::span<const double> FieldHistory::column(const Config::FieldHandle &h) const {
+        const Column *c = find(h);
+        if (!c) return {};
+        return c->values;
+    }
+
+    FieldHistory FieldHistory::subset(const std::span<const Config::FieldHandle> fields) const {
+        FieldHistory out;
+        out.tables.resize(tables.size());
+        for (const auto &h: fields) {
+            const Column *c = find(h);
+            if (!c) continue;
+            Table &table = out.tables[h.entry];
+            if (table.columns.empty()) {
+                table.size = tables[h.entry].size;
+                table.times = tables[h.entry].times;
+            }
+            if (!out.find(h)) {
+                table.columns.push_back(*c);
+            }
+        }
+        return out;
+    }
+
+    void FieldHistory::align(const std::span<const Config::FieldHandle> fields, std::vector<double> &t,
+                             std::vector<std::vector<double>> &columns) const {
+        t.clear();
+        columns.assign(fields.size(), {});
+
+        std::vector<uint32_t> entries;
+        std::vector<const double *> sources;
+        for (const auto &h: fields) {
+            const Column *c = find(h);
+            if (!c) return;
+            sources.push_back(c->values.data());
+            if (std::ranges::find(entries, h.entry) == entries.end()) {
+                entries.push_back(h.entry);
+            }
+        }
+        if (entries.empty()) return;
+
+        // merge the time columns of every involved buffer; cursor[i] is the next unread row of entries[i]
+        std::vector<size_t> cursor(entries.size(), 0);
+        std::vector<size_t> held(tables.size(), 0);
+        size_t total = 0;
+        for (const uint32_t e: entries) {
+            if (tables[e].times.empty()) return;
+            total += tables[e].times.size();
+        }
+        t.reserve(total);
+        for (auto &c: columns) c.reserve(total);
+
+        size_t seen = 0;
+        for (;;) {
+            size_t next = entries.size();
+            double next_t = std::numeric_limits<double>::infinity();
+            for (size_t i = 0; i < entries.size(); i++) {
+                const auto &times = tables[entries[i]].times;
+                if (cursor[i] < times.size() && times[cursor[i]] < next_t) {
+                    next_t = times[cursor[i]];
+                    next = i;
+                }
+            }
+            if (next == entries.size()) break;
+
+            const size_t row = cursor[next]++;
+            if (row == 0) seen++;
+            held[entries[next]] = row;
+            // nothing to hold until every buffer has received something
+            if (seen < entries.size()) continue;
+
+            t.push_back(next_t);
+            for (size_t f = 0; f < fields.size(); f++) {
+                columns[f].push_back(sources[f][held[fields[f].entry]]);
+            }
+        }
+    }
+} // DS
@@ -0,0 +1,88 @@
+/* date = October 17, 2026 4:15 PM */
+
+
+#ifndef FIELDHISTORY_H
+#define FIELDHISTORY_H
+
+#include <span>
+#include <vector>
+
+#include "Config.h"
+
+namespace DS {
+    /**
+     * The last FIELD_HISTORY_ROWS packets of every buffer, stored column-wise.
+     *
+     * Each buffer in the config gets a time column and one value column per field, all as doubles, so whole
+     * columns can be handed to batch expression evaluation. Older packets are dropped a block at a time, so memory
+     * stays bounded however long the session runs.
+     */
+    class FieldHistory {
+    public:
+        FieldHistory() = default;
+
+        /**
+         * Sets up empty columns for every buffer and field in `config`.
+         * @param config Config whose FieldHandles will be used to look columns up.
+         */
+        explicit FieldHistory(const Config &config);
+
+        /**
+         * Records one packet.
+         * @param entry Index of the buffer the packet belongs to.
+         * @param t Time the packet was received, in seconds.
+         * @param packet Packet data, laid out like the buffer.
+         */
+        void append(uint32_t entry, double t, std::span<const uint8_t> packet);
+
+        /**
+         * @param entry Index of a buffer.
+         * @return Receive times of every packet recorded for that buffer, ascending.
+         */
+        [[nodiscard]] std::span<const double> times(uint32_t entry) const;
+
+        /**
+         * @param h Field to look up.
+         * @return Every recorded value of that field, one per entry of `times(h.entry)`.
+         */
+        [[nodiscard]] std::span<const double> column(const Config::FieldHandle &h) const;
+
+        /**
+         * Lines up fields from possibly different buffers on one time axis.
+         *
+         * The axis is every receive time of every involved buffer, starting once each of them has received at least
+         * one packet. At each time a field holds its most recent value (sample-and-hold).
+         * @param fields Fields to align.
+         * @param t Output time axis.
+         * @param columns Output, one column per field, each the same length as `t`.
+         */
+        void align(std::span<const Config::FieldHandle> fields, std::vector<double> &t,
+                   std::vector<std::vector<double>> &columns) const;
+
+        /**
+         * Copies only what `align` needs for `fields`, so it can run on another thread while this one keeps growing.
+         * @param fields Fields to keep.
+         * @return The buffers `fields` belong to, with only their time column and the columns of `fields`.
+         */
+        [[nodiscard]] FieldHistory subset(std::span<const Config::FieldHandle> fields) const;
+
+    private:
+        struct Column {
+            uint32_t offset;
+            Config::FieldType ty;
+            std::vector<double> values;
+        };
+
+        struct Table {
+            size_t size;
+            std::vector<double> times;
+            std::vector<Column> columns;
+        };
+
+        [[nodiscard]] const Column *find(const Config::FieldHandle &h) const;
+
+        std::vector<Table> tables;
+    };
+} // DS
+
+#endif //FIELDHISTORY_H
@@ -2,142 +2,38 @@
 #include "imgui.h"
 
 #include <algorithm>
-#include <fstream>
 #include <filesystem>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "stb_image_write.h"
-
 namespace DS {
-    size_t write_file(void* ptr, size_t size, size_t nmemb, void* stream) {
-        std::ofstream* f = (std::ofstream*)stream;
-        f->write((char*)ptr, size * nmemb);
-        return size * nmemb;
-    }
-
-    int lon_to_tile_x(double lon, int z) {
-        return int((lon + 180.0) / 360.0 * (1 << z));
+    double lon_to_tile(double lon, int z) {
+        return (lon + 180.0) / 360.0 * (1 << z);
     }
 
-    int lat_to_tile_y(double lat, int z) {
+    double lat_to_tile(double lat, int z) {
         double lat_rad = lat * PI / 180.0;
-        return int(
-            (1.0 - std::log(std::tan(lat_rad) + 1.0 / std::cos(lat_rad)) / PI)
-            / 2.0 * (1 << z)
-        );
+        return (1.0 - std::log(std::tan(lat_rad) + 1.0 / std::cos(lat_rad)) / PI) / 2.0 * (1 << z);
     }
 
-    bool download_tile(int z, int x, int y, const std::filesystem::path& path) {
-        std::filesystem::create_directories(path.parent_path());
-
-        CURL* curl = curl_easy_init();
-        if (!curl) return false;
-
-        std::string url =
-            "https://tile.openstreetmap.org/" +
-            std::to_string(z) + "/" +
-            std::to_string(x) + "/" +
-            std::to_string(y) + ".png";
-
-        std::ofstream file(path, std::ios::binary);
-
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_file);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &file);
-        curl_easy_setopt(curl, CURLOPT_USERAGENT, "TileStitcher/1.0");
-
-        CURLcode res = curl_easy_perform(curl);
-        curl_easy_cleanup(curl);
-        file.close();
-
-        return res == CURLE_OK;
+    int lon_to_tile_x(double lon, int z) {
+        return int(lon_to_tile(lon, z));
     }
 
-    Image load_tile(const std::filesystem::path& path) {
-        int w, h, c;
-        unsigned char* data = stbi_load(path.string().c_str(), &w, &h, &c, 4);
-        if (!data) throw std::runtime_error("Failed to load tile");
-
-        Image img{w, h};
-        img.px.assign(data, data + w * h * 4);
-        stbi_image_free(data);
-        return img;
+    int lat_to_tile_y(double lat, int z) {
+        return int(lat_to_tile(lat, z));
     }
 
-    int make_map(double lon, double lat) try {
-        //std::filesystem::remove_all(TILE_DIR);
-        int center_x = lon_to_tile_x(lon, ZOOM);
-        int center_y = lat_to_tile_y(lat, ZOOM);
-
-        int tiles_needed = int(std::ceil(double(IMAGE_SIZE) / TILE_SIZE));
-        int half = tiles_needed / 2;
-
-        Image out;
-        out.w = tiles_needed * TILE_SIZE;
-        out.h = tiles_needed * TILE_SIZE;
-        out.px.resize(out.w * out.h * 4, 255);
-
-        for (int dy = -half; dy <= half; ++dy) {
-            for (int dx = -half; dx <= half; ++dx) {
-                int tx = center_x + dx;
-                int ty = center_y + dy;
-
-                std::filesystem::path tile_path =
-                    std::filesystem::path(TILE_DIR) /
-                    std::to_string(ZOOM) /
-                    std::to_string(tx) /
-                    (std::to_string(ty) + ".png");
-
-                if (!std::filesystem::exists(tile_path)) {
-                    download_tile(ZOOM, tx, ty, tile_path);
-                }
-
-                Image tile = load_tile(tile_path);
-
-                int ox = (dx + half) * TILE_SIZE;
-                int oy = (dy + half) * TILE_SIZE;
-
-                for (int y = 0; y < TILE_SIZE; ++y) {
-                    for (int x = 0; x < TILE_SIZE; ++x) {
-                        int dst = ((oy + y) * out.w + (ox + x)) * 4;
-                        int src = (y * TILE_SIZE + x) * 4;
-                        std::copy_n(&tile.px[src], 4, &out.px[dst]);
-                    }
-                }
+    std::string tile_url(const std::string& pattern, int z, int x, int y) {
+        std::string url = pattern;
+        const std::pair<const char*, int> parts[] = {{"{z}", z}, {"{x}", x}, {"{y}", y}};
+        for (const auto& [name, value] : parts) {
+            for (size_t at; (at = url.find(name)) != std::string::npos;) {
+                url.replace(at, 3, std::to_string(value));
             }
         }
-
-        // Crop to requested IMAGE_SIZE
-        Image final_img{IMAGE_SIZE, IMAGE_SIZE};
-        final_img.px.resize(IMAGE_SIZE * IMAGE_SIZE * 4);
-
-        int start = (out.w - IMAGE_SIZE) / 2;
-
-        for (int y = 0; y < IMAGE_SIZE; ++y) {
-            std::memcpy(
-                &final_img.px[y * IMAGE_SIZE * 4],
-                &out.px[((y + start) * out.w + start) * 4],
-                IMAGE_SIZE * 4
-            );
-        }
-
-        stbi_write_png(
-            "map.png",
-            final_img.w,
-            final_img.h,
-            4,
-            final_img.px.data(),
-            final_img.w * 4
-        );
-
-        //std::filesystem::remove_all(TILE_DIR);
-        return 0;
-    }
-    catch (const std::exception& e) {
-        return 1;
+        return url;
     }
 
     bool load_texture_from_memory(const void* data, size_t data_size, GLuint* out_texture, int* out_width, int* out_height)
@@ -6,26 +6,44 @@
 #include <vector>
 #include <filesystem>
 #include <cstring>
+#include <string>
 
 #include <curl/curl.h>
 
 namespace DS {
-    constexpr int ZOOM = 13; // 0–19
-    constexpr int IMAGE_SIZE = 200;
+    constexpr int ZOOM = 13; // zoom the map opens at, 0–19
+    constexpr int MAX_ZOOM = 19;
     constexpr int TILE_SIZE = 256;
     constexpr const char* TILE_DIR = "tiles";
+    // prefetched tiles for offline use, looked up before TILE_DIR (see TilePrefetch.h)
+    constexpr const char* TILE_ARCHIVE = "tiles.dstiles";
+    // where tiles are downloaded from; {z}, {x} and {y} are replaced by the tile's coordinates
+    constexpr const char* TILE_URL = "https://tile.openstreetmap.org/{z}/{x}/{y}.png";
     constexpr double PI = 3.14159265358979323846;
+    // decoded tiles are kept in square atlas textures of TILE_ATLAS_SIZE pixels (64 MiB), as many pages as the GPU's
+    // texture size limit needs to hold TILE_CACHE_TILES
+    constexpr int TILE_ATLAS_SIZE = 4096;
+    constexpr size_t TILE_CACHE_TILES = (TILE_ATLAS_SIZE / TILE_SIZE) * (TILE_ATLAS_SIZE / TILE_SIZE);
+    // how long a tile that failed to load is left before retrying
+    constexpr unsigned int TILE_RETRY_MS = 5000;
+    // tile requests waiting for the worker; older ones are dropped first, since the car has likely moved on
+    constexpr size_t TILE_QUEUE_LIMIT = 64;
+    // longest a tile download may take to connect, and in total; a stalled venue link then can't hold up closing
+    // the window (which waits for the tile worker) for more than a few seconds
+    constexpr long TILE_CONNECT_TIMEOUT_MS = 5000;
+    constexpr long TILE_TIMEOUT_MS = 10000;
 
     struct Image {
         int w, h;
         std::vector<unsigned char> px; // RGBA
     };
 
-    size_t write_file(void* ptr, size_t size, size_t nmemb, void* stream);
     int lon_to_tile_x(double lon, int z);
-    bool download_tile(int z, int x, int y, const std::filesystem::path& path);
-    Image load_tile(const std::filesystem::path& path);
-    int make_map(double lon, double lat);
+    int lat_to_tile_y(double lat, int z);
+    // tile coordinates with the position inside the tile kept as the fraction
+    double lon_to_tile(double lon, int z);
+    double lat_to_tile(double lat, int z);
+    std::string tile_url(const std::string& pattern, int z, int x, int y);
 
     // Image code from https://github.com/ocornut/imgui/wiki/Image-Loading-and-Displaying-Examples#example-for-opengl-users
     bool load_texture_from_memory(const void* data, size_t data_size, GLuint* out_texture, int* out_width, int* out_height);
@@ -0,0 +1,107 @@
+/* date = October 18, 2026 1:10 AM */
+
+
+#include "GpsTrack.h"
+
+#include <cmath>
+
+namespace DS {
+    // fixes per chunk; the open chunk is drawn unsimplified, so this also bounds how much of that there is
+    static constexpr size_t TRACK_CHUNK_POINTS = 256;
+    // how far, in pixels at a zoom level, the simplified track may stray from the real one. each level is simplified
+    // from the one above, so the total error stays under twice this
+    static constexpr double TRACK_TOLERANCE_PX = 0.5;
+
+    static uint32_t to_track(const double v) {
+        return static_cast<uint32_t>(std::clamp(v * TRACK_SCALE, 0.0, TRACK_SCALE - 1));
+    }
+
+    // squared distance from p to the segment a-b, in track units
+    static double distance2(const TrackPoint &p, const TrackPoint &a, const TrackPoint &b) {
+        const double dx = static_cast<double>(b.x) - a.x;
+        const double dy = static_cast<double>(b.y) - a.y;
+        double px = static_cast<double>(p.x) - a.x;
+        double py = static_cast<double>(p.y) - a.y;
+        const double len2 = dx * dx + dy * dy;
+        if (len2 > 0) {
+            const double t = std::clamp((px * dx + py * dy) / len2, 0.0, 1.0);
+            px -= t * dx;
+            py -= t * dy;
+        }
+        return px * px + py * py;
+    }
+
+    // Douglas-Peucker over the points `run` refers to; the first and last are always kept
+    static std::vector<uint32_t> simplify(const std::vector<TrackPoint> &points, const std::vector<uint32_t> &run,
+                                          const double tolerance) {
+        if (run.size() <= 2) return run;
+        std::vector<bool> keep(run.size(), false);
+        keep.front() = keep.back() = true;
+        const double limit = tolerance * tolerance;
+        std::vector<std::pair<size_t, size_t>> spans{{0, run.size() - 1}};
+        while (!spans.empty()) {
+            const auto [a, b] = spans.back();
+            spans.pop_back();
+            double worst = 0;
+            size_t at = a;
+            for (size_t i = a + 1; i < b; i++) {
+                const double d = distance2(points[run[i]], points[run[a]], points[run[b]]);
+                if (d > worst) {
+                    worst = d;
+                    at = i;
+                }
+            }
+            if (worst > limit) {
+                keep[at] = true;
+                spans.emplace_back(a, at);
+                spans.emplace_back(at, b);
+            }
+        }
+        std::vector<uint32_t> out;
+        for (size_t i = 0; i < run.size(); i++) {
+            if (keep[i]) out.push_back(run[i]);
+        }
+        return out;
+    }
+
+    bool GpsTrack::add(const double lat, const double lon) {
+        // Web Mercator stops short of the poles, at the latitude that makes the world square
+        if (!(std::abs(lat) <= 85.0511287798 && std::abs(lon) <= 180.0) || (lat == 0.0 && lon == 0.0)) return false;
+        const TrackPoint p{to_track(lon_to_tile(lon, 0)), to_track(lat_to_tile(lat, 0))};
+        if (!points.empty() && points.back().x == p.x && points.back().y == p.y) return false;
+
+        const auto i = static_cast<uint32_t>(points.size());
+        points.push_back(p);
+        if (tail.empty()) {
+            tail_bounds = {p.x, p.y, p.x, p.y};
+        } else {
+            tail_bounds.min_x = std::min(tail_bounds.min_x, p.x);
+            tail_bounds.min_y = std::min(tail_bounds.min_y, p.y);
+            tail_bounds.max_x = std::max(tail_bounds.max_x, p.x);
+            tail_bounds.max_y = std::max(tail_bounds.max_y, p.y);
+        }
+        tail.push_back(i);
+        if (tail.size() > TRACK_CHUNK_POINTS) {
+            close_chunk();
+        }
+        return true;
+    }
+
+    void GpsTrack::close_chunk() {
+        Chunk chunk{tail_bounds, {}};
+        // finest first, each level simplified from the one before, which has far fewer points than the raw fixes
+        std::vector<uint32_t> run = tail;
+        for (int z = MAX_ZOOM; z >= 0; z--) {
+            const double tolerance = TRACK_TOLERANCE_PX * TRACK_SCALE / (TILE_SIZE * std::exp2(z));
+            run = simplify(points, run, tolerance);
+            chunk.begin[z] = static_cast<uint32_t>(levels[z].size());
+            levels[z].insert(levels[z].end(), run.begin(), run.end());
+        }
+        chunks.push_back(chunk);
+
+        // the next chunk starts where this one ends, so the runs join up
+        const uint32_t last = tail.back();
+        tail.assign(1, last);
+        tail_bounds = {points[last].x, points[last].y, points[last].x, points[last].y};
+    }
+} // DS
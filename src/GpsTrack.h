@@ -0,0 +1,107 @@
+/* date = October 18, 2026 1:10 AM */
+
+
+#ifndef GPSTRACK_H
+#define GPSTRACK_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "GenerateMap.h"
+
+namespace DS {
+    // track coordinates span the world in 2^32 steps, about 1 cm at the equator
+    constexpr double TRACK_SCALE = 4294967296.0;
+
+    /**
+     * A position in Web Mercator coordinates, scaled from [0, 1) across the world to the full range of uint32_t.
+     * The same for every zoom level; multiply by `TILE_SIZE * 2^z / TRACK_SCALE` for pixels at zoom z.
+     */
+    struct TrackPoint {
+        uint32_t x, y;
+    };
+
+    struct TrackBounds {
+        uint32_t min_x, min_y, max_x, max_y;
+
+        [[nodiscard]] bool overlaps(const TrackBounds &o) const {
+            return min_x <= o.max_x && o.min_x <= max_x && min_y <= o.max_y && o.min_y <= max_y;
+        }
+    };
+
+    /**
+     * Every GPS fix of the session, for drawing the car's path over the map.
+     *
+     * Points are kept once, in projected coordinates, 8 bytes each. Every TRACK_CHUNK_POINTS they are closed off into
+     * a chunk, which is simplified with Douglas-Peucker once per zoom level, to within TRACK_TOLERANCE_PX pixels at
+     * that zoom, and stores the result as indices into the points. Chunks never change once closed, so adding a fix
+     * costs nothing more than the occasional chunk, and drawing at any zoom touches only the chunks in view and only
+     * the points that make a visible difference.
+     */
+    class GpsTrack {
+    public:
+        GpsTrack() = default;
+
+        /**
+         * Adds a fix to the end of the track. Fixes that are out of range, exactly at 0, 0 (what receivers report
+         * without a fix) or the same as the previous one are ignored.
+         * @param lat Latitude, in degrees.
+         * @param lon Longitude, in degrees.
+         * @return Whether the fix was added.
+         */
+        bool add(double lat, double lon);
+
+        [[nodiscard]] size_t size() const {
+            return points.size();
+        }
+
+        [[nodiscard]] const TrackPoint &operator[](const uint32_t i) const {
+            return points[i];
+        }
+
+        /**
+         * Calls `f(std::span<const uint32_t> run)` with the indices of the points of the track simplified for zoom
+         * `z`, one run per chunk that overlaps `view`, in track order. Consecutive chunks share their end point.
+         * @param z Zoom level the track is drawn at.
+         * @param view Area drawn; chunks entirely outside it are skipped.
+         * @param f Callback.
+         */
+        template<typename F>
+        void for_each_run(const int z, const TrackBounds &view, F &&f) const {
+            const size_t level = static_cast<size_t>(std::clamp(z, 0, MAX_ZOOM));
+            for (size_t c = 0; c < chunks.size(); c++) {
+                if (!chunks[c].bounds.overlaps(view)) continue;
+                const uint32_t begin = chunks[c].begin[level];
+                const uint32_t end = c + 1 < chunks.size() ? chunks[c + 1].begin[level]
+                                                           : static_cast<uint32_t>(levels[level].size());
+                f(std::span(levels[level]).subspan(begin, end - begin));
+            }
+            // the open chunk is still short, so it is drawn as is
+            if (tail.size() > 1 && tail_bounds.overlaps(view)) {
+                f(std::span<const uint32_t>(tail));
+            }
+        }
+
+    private:
+        struct Chunk {
+            TrackBounds bounds;
+            // start of the chunk's run in each of `levels`
+            std::array<uint32_t, MAX_ZOOM + 1> begin;
+        };
+
+        void close_chunk();
+
+        std::vector<TrackPoint> points;
+        std::vector<Chunk> chunks;
+        // indices of the points kept at each zoom level, chunk after chunk
+        std::array<std::vector<uint32_t>, MAX_ZOOM + 1> levels;
+        // indices of the points not yet in a chunk, starting with the last point of the last chunk
+        std::vector<uint32_t> tail;
+        TrackBounds tail_bounds{};
+    };
+} // DS
+
+#endif //GPSTRACK_H
@@ -3,46 +3,41 @@
 
 #include "Graph.h"
 
+#include <limits>
+#include <memory>
 #include <ranges>
+#include <thread>
 
 #include "implot.h"
 #include "expr/Parser.h"
 
 namespace DS {
-    Graph::Graph(const std::string &name, const std::string &formula, double data_width) {
+    Graph::Graph(const std::string &name, const std::string &formula, double data_width, size_t capacity)
+        : history(capacity), pyramid(capacity) {
         std::vector<Expr::Token> tokens;
         Expr::Lexer().lex(formula, tokens);
-        Expr::AST *ast = Expr::Parser().parse(tokens);
+        const std::unique_ptr<Expr::AST> ast{Expr::Parser().parse(tokens)};
 
         this->name = name;
-        this->formula = ast;
+        this->source = formula;
+        this->formula = Expr::Program::compile(ast.get());
         this->data_width = data_width;
     }
 
     void Graph::display() {
-        std::vector<double> x0{};
-        std::vector<double> y0{};
-        double x_min = 0, x_max = data_width,
-                y_min = std::numeric_limits<double>::max(),
-                y_max = std::numeric_limits<double>::min();
+        double x_min = 0, x_max = data_width, y_min = 0, y_max = 1;
 
+        std::span<const double> xs, ys;
+        visible(xs, ys);
         if (!history.empty()) {
-            auto last = history.back().first;
-            auto range = std::ranges::views::filter(history, [this, last](auto &p) {
-                return p.first >= last - this->data_width;
-            });
-
-            for (auto &[xd, yd]: range) {
-                x_min = std::fmax(0, xd - data_width);
-                x_max = std::fmax(data_width, xd);
-                if (yd < y_min) y_min = yd;
-                if (yd > y_max) y_max = yd;
-                x0.push_back(xd);
-                y0.push_back(yd);
+            const double last = history.xs().back();
+            x_min = std::fmax(0, last - data_width);
+            x_max = std::fmax(data_width, last);
+            if (!ys.empty()) {
+                const auto [lo, hi] = std::ranges::minmax_element(ys);
+                y_min = *lo;
+                y_max = *hi;
             }
-        } else {
-            y_min = 0;
-            y_max = 1;
         }
 
         double width = y_max - y_min;
@@ -51,47 +46,127 @@ namespace DS {
         ImPlot::SetNextAxesLimits(x_min, x_max, y_min - width * 0.1, y_max + width * 0.1, ImPlotCond_Always);
 
         if (ImPlot::BeginPlot(this->get_name())) {
+            this->plot_pixels = ImPlot::GetPlotSize().x;
             ImPlot::PlotLine(
                 name.c_str(),
-                x0.data(),
-                y0.data(),
-                static_cast<int>(x0.size())
+                xs.data(),
+                ys.data(),
+                static_cast<int>(xs.size())
             );
             ImPlot::EndPlot();
         }
     }
 
-    void Graph::update(const Dashboard &db, double x_val) {
-        if (!tractable(db)) return;
+    void Graph::update(const Config &config, double x_val) {
+        adopt_backfill();
+        if (!tractable()) return;
 
-        std::unordered_map<std::string, double> values;
-        for (const std::string &ident: this->formula->idents) {
-            values[ident] = *db.get_value<float>(ident);
+        for (size_t i = 0; i < this->bindings.size(); i++) {
+            this->slots[i] = config.read(this->bindings[i]);
         }
 
-        auto data_point = this->formula->evaluate(values);
-        if (data_point.has_value()) {
-            this->history.emplace_back(x_val, data_point.value());
+        push(x_val, this->formula->run(this->slots.data()));
+    }
+
+    void Graph::push(const double x, const double y) {
+        this->history.push(x, y);
+        this->pyramid.push(x, y);
+    }
+
+    void Graph::visible(std::span<const double> &xs, std::span<const double> &ys) const {
+        xs = ys = {};
+        if (history.empty()) return;
+        // only the points inside the last `data_width` seconds, as contiguous columns. Long windows are drawn from
+        // a decimated level so the vertex count stays around the plot's pixel width.
+        const double last = history.xs().back();
+        const auto view = pyramid.visible(history, last - data_width, last, plot_pixels);
+        xs = view.xs;
+        ys = view.ys;
+    }
+
+    void Graph::bind(const Config &config) {
+        this->bindings.clear();
+        this->slots.clear();
+        this->bound = false;
+        if (!this->formula) {
+            return;
         }
+
+        for (const std::string &ident: this->formula->slot_names()) {
+            const std::optional<Config::FieldHandle> handle = config.resolve(ident);
+            if (!handle) {
+                std::cerr << "Graph " << this->name << " uses unknown field " << ident << "!\n";
+                return;
+            }
+            this->bindings.push_back(*handle);
+            this->slots.push_back(0.0);
+        }
+        this->bound = true;
+    }
+
+    void Graph::backfill(const FieldHistory &fields) {
+        if (!tractable()) return;
+
+        auto job = std::make_shared<Backfill>(this->history.capacity());
+        this->backfilling = job;
+        // aligning and evaluating a long session takes far longer than a frame
+        std::thread([job, fields = fields.subset(this->bindings), bindings = this->bindings,
+                     formula = *this->formula] {
+            std::vector<double> times;
+            std::vector<std::vector<double>> columns;
+            fields.align(bindings, times, columns);
+
+            std::vector<const double *> inputs;
+            for (const auto &c: columns) {
+                inputs.push_back(c.data());
+            }
+            std::vector<double> values(times.size());
+            formula.run_batch(inputs.data(), times.size(), values.data());
+
+            // older points would be overwritten anyway; the pyramid reaches further back so it gets everything
+            const size_t cap = job->history.capacity();
+            for (size_t i = times.size() > cap ? times.size() - cap : 0; i < times.size(); i++) {
+                job->history.push(times[i], values[i]);
+            }
+            for (size_t i = 0; i < times.size(); i++) {
+                job->pyramid.push(times[i], values[i]);
+            }
+            job->done.store(true, std::memory_order_release);
+        }).detach();
     }
 
     /**
-     *
-     * @param db
-     * @return If the supplied Dashboard can provide all variables used in this graph's formula.
+     * Swaps in the points of a finished `backfill`, followed by the ones `update` added while it ran.
      */
-    bool Graph::tractable(const Dashboard &db) const {
-        if (this->formula == nullptr) {
-            return false;
+    void Graph::adopt_backfill() {
+        if (!this->backfilling || !this->backfilling->done.load(std::memory_order_acquire)) return;
+
+        Backfill &job = *this->backfilling;
+        const double until = job.history.empty() ? -std::numeric_limits<double>::infinity() : job.history.xs().back();
+        const auto xs = this->history.xs();
+        const auto ys = this->history.ys();
+        for (size_t i = this->history.lower_bound(until); i < xs.size(); i++) {
+            if (xs[i] <= until) continue;
+            job.history.push(xs[i], ys[i]);
+            job.pyramid.push(xs[i], ys[i]);
         }
+        this->history = std::move(job.history);
+        this->pyramid = std::move(job.pyramid);
+        this->backfilling.reset();
+    }
 
-        for (const std::string &ident: this->formula->idents) {
-            if (!db.has_key(ident)) return false;
-        }
-        return true;
+    /**
+     * @return If every variable used in this graph's formula was found by the last `bind`.
+     */
+    bool Graph::tractable() const {
+        return this->bound;
     }
 
     const char *Graph::get_name() const {
         return name.c_str();
     }
+
+    const std::string &Graph::get_formula() const {
+        return source;
+    }
 } // DS
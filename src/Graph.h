@@ -3,31 +3,101 @@
 
 #ifndef DELTASTATION_GRAPH_H
 #define DELTASTATION_GRAPH_H
+#include <atomic>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "Dashboard.h"
+#include "FieldHistory.h"
+#include "M4Pyramid.h"
+#include "RingSeries.h"
+#include "expr/Bytecode.h"
 
 namespace DS {
-    namespace Expr {
-        struct AST;
-    }
 
     class Graph {
     public:
-        explicit Graph(const std::string &name, const std::string &formula, double data_width);
+        /**
+         * @param name Graph name, shown as its window title.
+         * @param formula Expression over "{buffer_name}.{field_name}" identifiers.
+         * @param data_width Seconds of data shown at once.
+         * @param capacity Most points kept; older ones are dropped.
+         */
+        explicit Graph(const std::string &name, const std::string &formula, double data_width,
+                       size_t capacity = DEFAULT_GRAPH_CAPACITY);
+
+        // history is large, so graphs are only ever moved, never copied
+        Graph(const Graph &) = delete;
+        Graph &operator=(const Graph &) = delete;
+        Graph(Graph &&) = default;
+        Graph &operator=(Graph &&) = default;
 
         void display();
-        void update(const Dashboard &db, double x_val);
+        void update(const Config &config, double x_val);
+
+        /**
+         * Adds one point to the plot, as `update` does once it has evaluated the formula.
+         */
+        void push(double x, double y);
+
+        /**
+         * The points `display` draws: those inside the last `data_width` seconds, taken from the finest series that
+         * keeps the vertex count around the plot's pixel width.
+         * @param xs Output x values, ascending; empty if nothing has been plotted yet.
+         * @param ys Output y values, one per entry of `xs`.
+         */
+        void visible(std::span<const double> &xs, std::span<const double> &ys) const;
+
+        /**
+         * Resolves every variable in the formula against `config`. Must be called before `update`, and again if the
+         * config changes.
+         * @param config Config the variables are read from.
+         */
+        void bind(const Config &config);
 
-        [[nodiscard]] bool tractable(const Dashboard &db) const;
+        /**
+         * Fills in the plotted points with the formula evaluated over everything in `fields`, so a new or edited
+         * graph doesn't start out empty. Only the needed columns are copied here; the evaluation runs on its own
+         * thread, and a later `update` swaps the result in ahead of the points added since. Must be called after
+         * `bind`.
+         * @param fields Recorded values of the config this graph is bound to.
+         */
+        void backfill(const FieldHistory &fields);
+
+        [[nodiscard]] bool tractable() const;
 
         const char *get_name() const;
+        [[nodiscard]] const std::string &get_formula() const;
 
     private:
-        Expr::AST *formula = nullptr;
-        std::vector<std::pair<double, double>> history;
+        // points computed by a `backfill` thread; `done` is set once the thread no longer touches the rest
+        struct Backfill {
+            explicit Backfill(const size_t capacity) : history(capacity), pyramid(capacity) {
+            }
+
+            std::atomic<bool> done{false};
+            RingSeries history;
+            M4Pyramid pyramid;
+        };
+
+        void adopt_backfill();
+
+        std::optional<Expr::Program> formula;
+        // where each of the formula's slots is read from, and the values read on the last update
+        std::vector<Config::FieldHandle> bindings;
+        std::vector<double> slots;
+        bool bound = false;
+        RingSeries history;
+        // decimated copies of history for drawing long windows
+        M4Pyramid pyramid;
+        // shared with the thread, so replacing the graph mid-backfill never waits for it
+        std::shared_ptr<Backfill> backfilling;
+        // plot width on the last frame, to pick a pyramid level before the plot is laid out
+        double plot_pixels = 1000;
         std::string name;
+        std::string source;
         double data_width;
     };
 } // DS
@@ -3,6 +3,7 @@
 
 #include "IOSerial.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 
@@ -23,4 +24,31 @@ namespace DS {
     IOSerial::~IOSerial() {
         back.closeDevice();
     }
+
+    int IOSerial::read_bytes(std::span<uint8_t> out, unsigned int timeout_ms) {
+        if (out.empty()) return 0;
+
+        size_t count = 0;
+        int ready = back.available();
+        if (ready <= 0) {
+            // Nothing buffered yet: let serialib sleep until the first byte shows up. Asking for a
+            // single byte makes it return as soon as the link wakes up instead of waiting for a
+            // whole chunk.
+            const int got = back.readBytes(out.data(), 1, timeout_ms, READ_WAIT_SLEEP_US);
+            if (got <= 0) return got;
+            count = 1;
+            ready = back.available();
+        }
+
+        // Everything counted by `available` is already in the driver's buffer, so this read
+        // returns immediately.
+        const size_t want = std::min(static_cast<size_t>(std::max(ready, 0)), out.size() - count);
+        if (want > 0) {
+            const int got = back.readBytes(out.data() + count, want, timeout_ms, READ_WAIT_SLEEP_US);
+            if (got < 0) return got;
+            count += got;
+        }
+
+        return static_cast<int>(count);
+    }
 } // DS
\ No newline at end of file
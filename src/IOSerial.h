@@ -7,6 +7,7 @@
 #include <serialib.h>
 #include <cstdint>
 #include <iostream>
+#include <span>
 
 #include "common.h"
 
@@ -39,39 +40,61 @@ public:
         return c;
     }
 
+    /**
+     * Reads every byte that is already waiting on the port (up to `out.size()`) into `out`. If
+     * nothing is waiting, this sleeps until the first byte arrives or `timeout_ms` elapses, so
+     * callers never spin on an idle link.
+     * @param out Caller-owned storage for the incoming bytes.
+     * @param timeout_ms Longest time to wait for the first byte.
+     * @return Number of bytes written to `out`, 0 on timeout, or a negative serialib error code.
+     */
+    virtual int read_bytes(std::span<uint8_t> out, unsigned int timeout_ms);
+
+    /**
+     * @return True once a reader with a finite source (like a recording) has nothing more to give. A serial port never
+     * ends.
+     */
+    [[nodiscard]] virtual bool at_end() const {
+        return false;
+    }
+
     /**
      * Writes out a byte to the serial output associated with the current port.
+     * @return false if the write failed; the error is printed.
      */
-    virtual void put_byte(const char c) {
-        if (const int err = back.writeChar(c)) {
-            // TODO: recover gracefully
+    virtual bool put_byte(const char c) {
+        // serialib returns 1 on success and a negative code on failure
+        if (const int err = back.writeChar(c); err != 1) {
             std::cerr << "Error while writing char to serial output: " << err << '\n';
-            exit(-1);
+            return false;
         }
+        return true;
     }
 
     /**
      * Writes out a string to the serial output associated with the current port.
+     * @return false if the write failed; the error is printed.
      */
-    virtual void put(const std::string &s) {
-        if (const int err = back.writeString(s.c_str())) {
-            // TODO: recover gracefully
+    virtual bool put(const std::string &s) {
+        if (const int err = back.writeString(s.c_str()); err != 1) {
             std::cerr << "Error while writing string to serial output: " << err << '\n';
-            exit(-1);
+            return false;
         }
+        return true;
     }
 
     /**
      * Writes a buffer to the serial output associated with the current port.
      * Note that the length of the buffer must be greater than or equal to the
      * `len` parameter.
+     * @return false if the write failed; the error is printed.
      */
-    virtual void put_bytes(const char *buf, const int len) {
-        if (const int err = back.writeBytes(buf, len)) {
-            // TODO: recover gracefully
+    virtual bool put_bytes(const char *buf, const int len) {
+        if (const int err = back.writeBytes(buf, len); err != 1) {
             std::cerr << "Error while writing buffer to serial output: " << err << '\n';
-            exit(-1);
+            return false;
         }
+        return true;
     }
 
     /**
@@ -82,6 +105,8 @@ public:
 private:
     serialib back;
     size_t reader_timeout = 3000;
+    // how long serialib sleeps between checks while waiting for the first byte of a read
+    static constexpr unsigned int READ_WAIT_SLEEP_US = 500;
 };
 
 } // DS
@@ -0,0 +1,313 @@
+/* date = October 17, 2026 9:20 PM */
+
+
+#include "Importer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string_view>
+#include <thread>
+
+#include "ColumnStore.h"
+#include "MappedFile.h"
+#include "SessionLog.h"
+
+namespace DS {
+    // CSV bytes one worker parses at a time; big files are split so a single long log still uses every core
+    static constexpr size_t IMPORT_CHUNK_BYTES = 4 << 20;
+
+    namespace {
+        // what a CSV column is written into
+        struct Target {
+            enum Kind { Skip, Value, UnixTime, CarTime, HostTime } kind = Skip;
+            uint32_t offset = 0;
+            Config::FieldType ty{};
+        };
+
+        struct CsvFile {
+            MappedFile file;
+            uint8_t type;
+            std::vector<Target> targets;
+            // older logs print 8-bit fields as characters and have no receive time
+            bool legacy;
+        };
+
+        struct Chunk {
+            size_t file;
+            // byte range of whole rows
+            size_t begin;
+            size_t end;
+            std::vector<PacketSlot> rows;
+            size_t bad_rows = 0;
+        };
+    }
+
+    static std::vector<std::filesystem::path> find_log_directories(const std::vector<std::filesystem::path> &paths) {
+        auto has_csv = [](const std::filesystem::path &dir) {
+            std::error_code ec;
+            for (const auto &e: std::filesystem::directory_iterator(dir, ec)) {
+                if (e.path().extension() == ".csv") return true;
+            }
+            return false;
+        };
+
+        std::vector<std::filesystem::path> out;
+        for (const auto &path: paths) {
+            if (!std::filesystem::is_directory(path)) {
+                std::cerr << "Import: " << path << " is not a directory\n";
+                continue;
+            }
+            if (has_csv(path)) {
+                out.push_back(path);
+                continue;
+            }
+            std::vector<std::filesystem::path> children;
+            for (const auto &e: std::filesystem::directory_iterator(path)) {
+                if (e.is_directory() && has_csv(e.path())) children.push_back(e.path());
+            }
+            std::ranges::sort(children);
+            out.insert(out.end(), children.begin(), children.end());
+        }
+        return out;
+    }
+
+    static std::string_view next_line(const std::string_view text, size_t &pos) {
+        const size_t end = std::min(text.find('\n', pos), text.size());
+        std::string_view line = text.substr(pos, end - pos);
+        pos = end + 1;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        return line;
+    }
+
+    static std::optional<CsvFile> open_csv(const Config &config, const std::filesystem::path &path) {
+        const std::string name = path.stem().string();
+        const auto id = config.get_id_of(name);
+        const Config::Entry *entry = config.get(name);
+        if (!id || !entry) {
+            std::cerr << "Import: no buffer named " << name << " in the config, skipping " << path << "\n";
+            return std::nullopt;
+        }
+        auto file = MappedFile::open(path);
+        if (!file) return std::nullopt;
+
+        CsvFile csv{std::move(*file), static_cast<uint8_t>(*id), {}, true};
+        const std::string_view text{reinterpret_cast<const char *>(csv.file.data()), csv.file.size()};
+        size_t pos = 0;
+        const std::string_view header = next_line(text, pos);
+        for (size_t start = 0; start <= header.size();) {
+            const size_t comma = std::min(header.find(',', start), header.size());
+            const std::string column{header.substr(start, comma - start)};
+            start = comma + 1;
+
+            Target &t = csv.targets.emplace_back();
+            if (column == "unix_timestamp") {
+                t.kind = Target::UnixTime;
+            } else if (column == "car_timestamp") {
+                t.kind = Target::CarTime;
+                csv.legacy = false;
+            } else if (column == "host_monotonic_ns") {
+                t.kind = Target::HostTime;
+            } else if (const auto field = entry->get(column)) {
+                t.kind = Target::Value;
+                t.offset = static_cast<uint32_t>(field->offset);
+                t.ty = field->ty;
+            } else {
+                std::cerr << "Import: " << path << " has a column " << column << " the config doesn't know\n";
+            }
+        }
+        return csv;
+    }
+
+    template<typename T>
+    static bool parse_number(const std::string_view cell, T &v) {
+        const auto [end, ec] = std::from_chars(cell.data(), cell.data() + cell.size(), v);
+        return ec == std::errc{} && end == cell.data() + cell.size();
+    }
+
+    static bool parse_row(const CsvFile &csv, const std::string_view line, PacketSlot &slot) {
+        slot = {};
+        slot.tag = SLOT_PACKET;
+        slot.type = csv.type;
+
+        size_t start = 0;
+        for (size_t i = 0; i < csv.targets.size(); i++) {
+            if (start > line.size()) return false;
+            const size_t comma = std::min(line.find(',', start), line.size());
+            const std::string_view cell = line.substr(start, comma - start);
+            start = comma + 1;
+
+            const Target &t = csv.targets[i];
+            bool ok = true;
+            switch (t.kind) {
+                case Target::Skip:
+                    break;
+                case Target::UnixTime:
+                    ok = parse_number(cell, slot.unix_time);
+                    break;
+                case Target::CarTime:
+                    ok = parse_number(cell, slot.car_timestamp);
+                    break;
+                case Target::HostTime:
+                    ok = parse_number(cell, slot.host_monotonic_ns);
+                    break;
+                case Target::Value: {
+                    constexpr uint8_t probe[sizeof(uint64_t)]{};
+                    ok = Config::visit_field(t.ty, probe, [&](auto tag) {
+                        using V = decltype(tag);
+                        V v{};
+                        if constexpr (sizeof(V) == 1) {
+                            if (csv.legacy) {
+                                // written with `operator<<`, so the byte itself (a NUL byte may leave the cell empty)
+                                if (cell.size() > 1) return false;
+                                v = static_cast<V>(cell.empty() ? 0 : cell[0]);
+                            } else {
+                                int wide;
+                                if (!parse_number(cell, wide)) return false;
+                                v = static_cast<V>(wide);
+                            }
+                        } else if (!parse_number(cell, v)) {
+                            return false;
+                        }
+                        memcpy(slot.data + t.offset, &v, sizeof(v));
+                        return true;
+                    });
+                    break;
+                }
+            }
+            if (!ok) return false;
+        }
+        // extra cells mean the row doesn't match the header
+        if (start <= line.size()) return false;
+
+        if (csv.legacy) {
+            slot.host_monotonic_ns = slot.unix_time * 1'000'000'000;
+        }
+        return true;
+    }
+
+    static void parse_chunk(const CsvFile &csv, Chunk &chunk) {
+        const std::string_view text{reinterpret_cast<const char *>(csv.file.data()), chunk.end};
+        size_t pos = chunk.begin;
+        PacketSlot slot;
+        while (pos < chunk.end) {
+            const std::string_view line = next_line(text, pos);
+            if (line.empty()) continue;
+            if (parse_row(csv, line, slot)) {
+                chunk.rows.push_back(slot);
+            } else {
+                chunk.bad_rows++;
+            }
+        }
+    }
+
+    // splits the rows after the header into pieces of about IMPORT_CHUNK_BYTES, cut at line ends
+    static void split(const CsvFile &csv, const size_t file, std::vector<Chunk> &chunks) {
+        const std::string_view text{reinterpret_cast<const char *>(csv.file.data()), csv.file.size()};
+        size_t pos = 0;
+        next_line(text, pos);
+        while (pos < text.size()) {
+            size_t end = std::min(pos + IMPORT_CHUNK_BYTES, text.size());
+            if (end < text.size()) {
+                end = std::min(text.find('\n', end), text.size());
+            }
+            chunks.push_back({file, pos, end, {}, 0});
+            pos = end + 1;
+        }
+    }
+
+    static bool import_directory(const Config &config, const std::filesystem::path &dir, const unsigned workers,
+                                 size_t &bytes) {
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<CsvFile> files;
+        for (const auto &e: std::filesystem::directory_iterator(dir)) {
+            if (e.path().extension() != ".csv") continue;
+            if (auto csv = open_csv(config, e.path())) {
+                files.push_back(std::move(*csv));
+            }
+        }
+        // keep the output the same from run to run
+        std::ranges::sort(files, {}, [](const CsvFile &f) { return f.type; });
+
+        std::vector<Chunk> chunks;
+        for (size_t i = 0; i < files.size(); i++) {
+            split(files[i], i, chunks);
+        }
+
+        std::atomic<size_t> next{0};
+        auto work = [&] {
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < chunks.size();) {
+                parse_chunk(files[chunks[i].file], chunks[i]);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < std::min<size_t>(workers, chunks.size()); i++) {
+            threads.emplace_back(work);
+        }
+        work();
+        for (auto &t: threads) {
+            t.join();
+        }
+
+        size_t rows = 0, bad = 0;
+        for (const Chunk &c: chunks) {
+            rows += c.rows.size();
+            bad += c.bad_rows;
+        }
+        std::vector<PacketSlot> packets;
+        packets.reserve(rows);
+        for (Chunk &c: chunks) {
+            packets.insert(packets.end(), c.rows.begin(), c.rows.end());
+            c.rows = {};
+        }
+        // buffers were logged to separate files; interleave them by receive time, rows of a file staying in order
+        std::ranges::stable_sort(packets, {}, &PacketSlot::host_monotonic_ns);
+
+        SessionWriter session;
+        if (!session.open(dir / "session.dslog", SessionWriter::encode_header(config))) return false;
+        {
+            ColumnStore columns{ColumnStore::describe(config), dir / "columns"};
+            for (const PacketSlot &p: packets) {
+                session.append(p);
+                columns.append(p.type, p.host_monotonic_ns, p.data);
+            }
+        }
+        session.close();
+
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size_t dir_bytes = 0;
+        for (const CsvFile &f: files) dir_bytes += f.file.size();
+        bytes += dir_bytes;
+        printf("%s: %zu rows from %zu files (%zu unreadable), %.1f MB in %.2f s, %.1f MB/s\n",
+               dir.string().c_str(), rows, files.size(), bad, dir_bytes / 1e6, secs, dir_bytes / 1e6 / secs);
+        return true;
+    }
+
+    int import_csv(const Config &config, const std::vector<std::filesystem::path> &paths) {
+        const auto dirs = find_log_directories(paths);
+        if (dirs.empty()) {
+            std::cerr << "Import: no CSV logs found\n";
+            return 1;
+        }
+        const unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+        printf("Importing %zu log directories with %u threads\n", dirs.size(), workers);
+
+        const auto start = std::chrono::steady_clock::now();
+        size_t bytes = 0, failed = 0;
+        for (const auto &dir: dirs) {
+            // sessions the Logger recorded already have an exact binary log, which the CSV can only approximate
+            if (std::filesystem::exists(dir / "session.dslog")) {
+                printf("%s: skipped, already has session.dslog\n", dir.string().c_str());
+                continue;
+            }
+            if (!import_directory(config, dir, workers, bytes)) failed++;
+        }
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("Imported %.1f MB in %.2f s, %.1f MB/s\n", bytes / 1e6, secs, bytes / 1e6 / secs);
+        return failed ? 1 : 0;
+    }
+} // DS
@@ -0,0 +1,28 @@
+/* date = October 17, 2026 9:20 PM */
+
+
+#ifndef IMPORTER_H
+#define IMPORTER_H
+
+#include <filesystem>
+#include <vector>
+
+#include "Config.h"
+
+namespace DS {
+    /**
+     * Converts CSV logs into `session.dslog` and a `columns/` store next to them, using every core. Each path is
+     * either one log directory (holding `<buffer>.csv` files) or a directory of them, like `csv_storage`. Directories
+     * that already have a `session.dslog`, like every one the Logger writes, are skipped and left untouched.
+     *
+     * Both the current format and the older per-frame one (no `car_timestamp`/`host_monotonic_ns` columns, 8-bit
+     * fields written as raw characters) are understood. Rows of the older format only know the wall-clock second they
+     * were written, so that is used as their receive time. Throughput is printed per directory and in total.
+     * @param config Config the logs were written with. CSV columns it doesn't know are skipped.
+     * @param paths Directories to convert.
+     * @return Process exit code: 0 if every directory was converted.
+     */
+    int import_csv(const Config &config, const std::vector<std::filesystem::path> &paths);
+} // DS
+
+#endif //IMPORTER_H
@@ -3,6 +3,9 @@
 
 #include "InputParameters.h"
 
+#include <array>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 
@@ -48,6 +51,150 @@ namespace DS {
                 curr_arg++;
                 debug = true;
                 printf("Using Debug Mode\n");
+            } else if (streq(argv[curr_arg], "--replay")) {
+                curr_arg++;
+
+                if (curr_arg < argc) {
+                    replay_path = argv[curr_arg];
+                    curr_arg++;
+                } else {
+                    printf("Input error: expected FILE\n");
+                    usage();
+                    exit(1);
+                }
+            } else if (streq(argv[curr_arg], "--capture")) {
+                curr_arg++;
+
+                if (curr_arg < argc) {
+                    capture_path = argv[curr_arg];
+                    curr_arg++;
+                } else {
+                    printf("Input error: expected FILE\n");
+                    usage();
+                    exit(1);
+                }
+            } else if (streq(argv[curr_arg], "--speed")) {
+                curr_arg++;
+
+                if (curr_arg < argc) {
+                    if (streq(argv[curr_arg], "max")) {
+                        replay_speed = 0;
+                    } else {
+                        replay_speed = std::strtod(argv[curr_arg], nullptr);
+                        if (replay_speed <= 0) {
+                            printf("Input error: speed must be a positive number or \"max\"\n");
+                            exit(1);
+                        }
+                    }
+                    curr_arg++;
+                } else {
+                    printf("Input error: expected X\n");
+                    usage();
+                    exit(1);
+                }
+            } else if (streq(argv[curr_arg], "--synthetic")) {
+                curr_arg++;
+                synthetic = true;
+            } else if (streq(argv[curr_arg], "--headless")) {
+                curr_arg++;
+                no_window = true;
+            } else if (streq(argv[curr_arg], "--bench-fec")) {
+                curr_arg++;
+                bench = true;
+            } else if (streq(argv[curr_arg], "--bench-graphs")) {
+                curr_arg++;
+                bench_graph = true;
+            } else if (streq(argv[curr_arg], "--import")) {
+                curr_arg++;
+
+                if (curr_arg < argc) {
+                    import_paths.emplace_back(argv[curr_arg]);
+                    curr_arg++;
+                } else {
+                    printf("Input error: expected DIR\n");
+                    usage();
+                    exit(1);
+                }
+            } else if (streq(argv[curr_arg], "--prefetch-tiles")) {
+                curr_arg++;
+
+                if (curr_arg < argc) {
+                    prefetch_path = argv[curr_arg];
+                    prefetch.output = prefetch_path;
+                    curr_arg++;
+                } else {
+                    printf("Input error: expected FILE\n");
+                    usage();
+                    exit(1);
+                }
+            } else if (streq(argv[curr_arg], "--route")) {
+                curr_arg++;
+
+                if (curr_arg < argc) {
+                    prefetch.route = argv[curr_arg];
+                    curr_arg++;
+                } else {
+                    printf("Input error: expected FILE\n");
+                    usage();
+                    exit(1);
+                }
+            } else if (streq(argv[curr_arg], "--bbox")) {
+                curr_arg++;
+
+                std::array<double, 4> box{};
+                if (curr_arg < argc &&
+                    sscanf(argv[curr_arg], "%lf,%lf,%lf,%lf", &box[0], &box[1], &box[2], &box[3]) == 4) {
+                    if (box[0] > box[2] || box[1] > box[3]) {
+                        printf("Input error: bbox must be south,west,north,east\n");
+                        exit(1);
+                    }
+                    prefetch.bbox = box;
+                    curr_arg++;
+                } else {
+                    printf("Input error: expected S,W,N,E\n");
+                    usage();
+                    exit(1);
+                }
+            } else if (streq(argv[curr_arg], "--zoom")) {
+                curr_arg++;
+
+                int lo, hi;
+                const int n = curr_arg < argc ? sscanf(argv[curr_arg], "%d-%d", &lo, &hi) : 0;
+                if (n >= 1) {
+                    prefetch.min_zoom = lo;
+                    prefetch.max_zoom = n == 2 ? hi : lo;
+                    curr_arg++;
+                } else {
+                    printf("Input error: expected MIN-MAX\n");
+                    usage();
+                    exit(1);
+                }
+            } else if (streq(argv[curr_arg], "--tile-radius")) {
+                curr_arg++;
+
+                if (curr_arg < argc) {
+                    prefetch.radius = std::atoi(argv[curr_arg]);
+                    if (prefetch.radius < 0) {
+                        printf("Input error: tile radius can't be negative\n");
+                        exit(1);
+                    }
+                    curr_arg++;
+                } else {
+                    printf("Input error: expected N\n");
+                    usage();
+                    exit(1);
+                }
+            } else if (streq(argv[curr_arg], "--tile-url")) {
+                curr_arg++;
+
+                if (curr_arg < argc) {
+                    prefetch.url = argv[curr_arg];
+                    curr_arg++;
+                } else {
+                    printf("Input error: expected URL\n");
+                    usage();
+                    exit(1);
+                }
             } else if (streq(argv[curr_arg], "--config")) {
                 curr_arg++;
 
@@ -66,7 +213,12 @@ namespace DS {
             }
         }
 
-        if (!debug && (!port || baud == -1)) {
+        if (bench || bench_graph || import_mode() || prefetch_mode()) {
+            return;
+        }
+
+        // a replay is paced by its own timestamps, or by --baud for raw captures
+        if (!debug && !replay_mode() && !synthetic && (!port || baud == -1)) {
             usage();
             exit(1);
         }
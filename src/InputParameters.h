@@ -4,7 +4,10 @@
 #ifndef INPUTPARAMETERS_H
 #define INPUTPARAMETERS_H
 #include <string>
+#include <vector>
 
+#include "GenerateMap.h"
+#include "TilePrefetch.h"
 #include "common.h"
 
 namespace DS {
@@ -28,13 +31,58 @@ namespace DS {
 
         [[nodiscard]] bool debug_mode() const { return debug; }
 
+        [[nodiscard]] bool bench_fec() const { return bench; }
+
+        [[nodiscard]] bool bench_graphs() const { return bench_graph; }
+
+        [[nodiscard]] bool headless() const { return no_window; }
+
+        [[nodiscard]] bool synthetic_mode() const { return synthetic; }
+
+        [[nodiscard]] bool replay_mode() const { return !replay_path.empty(); }
+
+        [[nodiscard]] const std::string &get_replay_path() const { return replay_path; }
+
+        /**
+         * @return Replay (or synthetic) speed multiplier, 0 meaning as fast as possible.
+         */
+        [[nodiscard]] double get_replay_speed() const { return replay_speed; }
+
+        [[nodiscard]] bool capture_mode() const { return !capture_path.empty(); }
+
+        [[nodiscard]] const std::string &get_capture_path() const { return capture_path; }
+
+        [[nodiscard]] bool import_mode() const { return !import_paths.empty(); }
+
+        /**
+         * @return Log directories given with `--import`, in order.
+         */
+        [[nodiscard]] const std::vector<std::string> &get_import_paths() const { return import_paths; }
+
+        [[nodiscard]] bool prefetch_mode() const { return !prefetch_path.empty(); }
+
+        /**
+         * @return The tile prefetch asked for with `--prefetch-tiles` and the options that go with it.
+         */
+        [[nodiscard]] const TilePrefetchRequest &get_prefetch() const { return prefetch; }
+
         const std::string &get_config() { return config_path; }
 
     private:
         const char *port{};
         int baud = -1;
         bool debug = false;
+        bool bench = false;
+        bool bench_graph = false;
+        bool no_window = false;
+        bool synthetic = false;
         std::string config_path = "config.toml";
+        std::vector<std::string> import_paths;
+        std::string replay_path;
+        double replay_speed = 1.0;
+        std::string prefetch_path;
+        TilePrefetchRequest prefetch{{}, {}, std::nullopt, 12, 16, 1, TILE_URL};
+        std::string capture_path;
 
         /**
            * Prints a message on how to use this program. Only printed if the first
@@ -46,6 +94,26 @@ namespace DS {
             printf("\t--baud BAUD: Specify BAUD rate for serial connection.\n");
             printf("\t--config FILE: Specify FILE for config.\n");
             printf("\t--debug: Enter debug mode. --port & --baud are unnecessary with this.\n");
+            printf("\t--replay FILE: Play a session log (.dslog), capture (.dscap) or raw serial bytes instead of reading a\n");
+            printf("\t               port.\n");
+            printf("\t--synthetic: Generate packets for every buffer in the config, as set in its [synthetic] table,\n");
+            printf("\t             instead of reading a port.\n");
+            printf("\t--speed X: Replay or generate at X times real time, or \"max\" for as fast as possible.\n");
+            printf("\t           Defaults to 1.\n");
+            printf("\t--capture FILE: Also save the raw serial bytes, with receive times, to FILE (.dscap).\n");
+            printf("\t--headless: Receive and log without opening a window, until Ctrl+C.\n");
+            printf("\t--bench-fec: Benchmark RS-FEC encoding and decoding, then exit.\n");
+            printf("\t--bench-graphs: Check that drawing a graph costs about the same after 10 hours of data as after\n");
+            printf("\t                one minute, then exit (non-zero if it doesn't).\n");
+            printf("\t--prefetch-tiles FILE: Download the map tiles of an area into the archive FILE for offline use,\n");
+            printf("\t                      then exit. Name it %s to have the map use it.\n", TILE_ARCHIVE);
+            printf("\t--route FILE: Prefetch along the route in FILE, one \"lat,lon\" point per line.\n");
+            printf("\t--bbox S,W,N,E: Prefetch the box between latitudes S and N and longitudes W and E.\n");
+            printf("\t--zoom MIN-MAX: Zoom levels to prefetch. Defaults to 12-16.\n");
+            printf("\t--tile-radius N: Tiles to prefetch on each side of the route. Defaults to 1.\n");
+            printf("\t--tile-url URL: Tile server to prefetch from, with {z}, {x} and {y} in the path.\n");
+            printf("\t--import DIR: Convert the CSV logs in DIR (or in each directory inside it) to binary session\n");
+            printf("\t              logs using the --config FILE layout, then exit. May be given more than once.\n");
         }
 
         static bool streq(const char *s0, const char *s1);
@@ -0,0 +1,226 @@
+/* date = October 17, 2026 7:40 PM */
+
+
+#include "Logger.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace DS {
+    Logger::Logger() {
+        writer = std::thread(&Logger::run, this);
+    }
+
+    Logger::~Logger() {
+        close();
+        stopping.store(true, std::memory_order_release);
+        writer.join();
+    }
+
+    void Logger::open(const Config &config, const std::filesystem::path &directory) {
+        Schema schema;
+        schema.directory = directory;
+        schema.session_header = SessionWriter::encode_header(config);
+        schema.column_layout = ColumnStore::describe(config);
+        schema.by_type.fill(-1);
+        for (size_t id = 0; id < schema.by_type.size(); id++) {
+            if (const auto *entry = config.get_by_id(id)) {
+                schema.by_type[id] = static_cast<int32_t>(entry->get_index());
+            }
+        }
+        for (const auto &[name, entry]: config.get_entries()) {
+            if (schema.outputs.size() <= entry.get_index()) {
+                schema.outputs.resize(entry.get_index() + 1);
+            }
+            Output &out = schema.outputs[entry.get_index()];
+            out.name = name;
+            out.size = entry.get_size();
+            // columns in name order, as they have always been
+            for (const auto &[field_name, field]: entry.get_fields()) {
+                out.header.push_back(field_name);
+                out.columns.push_back({static_cast<uint32_t>(field.offset), field.ty});
+            }
+            out.header.emplace_back("unix_timestamp");
+            out.header.emplace_back("car_timestamp");
+            out.header.emplace_back("host_monotonic_ns");
+        }
+
+        submit(std::move(schema));
+    }
+
+    void Logger::close() {
+        Schema schema;
+        schema.by_type.fill(-1);
+        submit(std::move(schema));
+    }
+
+    void Logger::submit(Schema schema) {
+        std::lock_guard guard{pending_lock};
+        schema.generation = generation.load(std::memory_order_relaxed) + 1;
+        pending = std::move(schema);
+        has_pending.store(true, std::memory_order_release);
+        // published last: a row stamped with the new generation always finds its schema pending
+        generation.store(pending->generation, std::memory_order_release);
+    }
+
+    void Logger::run() {
+        auto last_flush = std::chrono::steady_clock::now();
+        for (;;) {
+            const bool stop = stopping.load(std::memory_order_acquire);
+
+            const size_t n = queue.drain([this](const Record &r) {
+                // rows logged after an open/close that the writer hasn't switched to yet
+                if (r.generation != active_generation && has_pending.load(std::memory_order_acquire)) {
+                    apply_pending();
+                }
+                if (r.generation == active_generation) {
+                    write(r);
+                }
+            });
+            // queue is empty, so nothing of the old generation is left to write
+            if (has_pending.load(std::memory_order_acquire)) {
+                apply_pending();
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (now - last_flush >= std::chrono::milliseconds(LOG_FLUSH_INTERVAL_MS)) {
+                flush_all();
+                last_flush = now;
+            }
+
+            if (stop) break;
+            if (n == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(LOG_IDLE_SLEEP_MS));
+            }
+        }
+        close_all();
+    }
+
+    void Logger::apply_pending() {
+        std::optional<Schema> next;
+        {
+            std::lock_guard guard{pending_lock};
+            next = std::move(pending);
+            pending = std::nullopt;
+            has_pending.store(false, std::memory_order_release);
+        }
+        if (!next) return;
+
+        close_all();
+        outputs = std::move(next->outputs);
+        by_type = next->by_type;
+        active_generation = next->generation;
+        if (!next->directory) return;
+
+        std::error_code ec;
+        std::filesystem::create_directories(*next->directory, ec);
+        if (ec) {
+            std::cerr << "Logger: could not create " << *next->directory << ": " << ec.message() << "\n";
+        }
+        session.open(*next->directory / "session.dslog", next->session_header);
+        columns = std::make_unique<ColumnStore>(next->column_layout, *next->directory / "columns");
+
+        for (Output &out: outputs) {
+            if (out.name.empty()) continue;
+            const std::filesystem::path path = *next->directory / (out.name + ".csv");
+            out.file = fopen(path.string().c_str(), "wb");
+            if (!out.file) {
+                std::cerr << "Logger: could not open " << path << "\n";
+                continue;
+            }
+            // rows are already batched in `buffer`
+            setvbuf(out.file, nullptr, _IONBF, 0);
+            out.buffer.resize(LOG_BUFFER_BYTES);
+
+            std::string header;
+            for (size_t i = 0; i < out.header.size(); i++) {
+                header += out.header[i];
+                header += i + 1 == out.header.size() ? '\n' : ',';
+            }
+            fwrite(header.data(), 1, header.size(), out.file);
+        }
+    }
+
+    template<typename T>
+    static char *format_value(char *first, char *last, const T v) {
+        if constexpr (sizeof(T) == 1) {
+            // 8-bit fields print as numbers rather than characters
+            return std::to_chars(first, last, static_cast<int>(v)).ptr;
+        } else {
+            return std::to_chars(first, last, v).ptr;
+        }
+    }
+
+    void Logger::write(const Record &r) {
+        // every packet goes to the session log, even ones the config has no buffer for
+        PacketSlot slot{};
+        slot.tag = SLOT_PACKET;
+        slot.type = r.type;
+        slot.car_timestamp = r.car_timestamp;
+        slot.host_monotonic_ns = r.host_monotonic_ns;
+        slot.unix_time = r.unix_time;
+        memcpy(slot.data, r.data, sizeof(slot.data));
+        session.append(slot);
+        if (columns) {
+            columns->append(r.type, r.host_monotonic_ns, r.data);
+        }
+
+        const int32_t index = by_type[r.type];
+        if (index < 0 || static_cast<size_t>(index) >= outputs.size()) return;
+        Output &out = outputs[index];
+        if (!out.file) return;
+
+        // worst case a value takes 24 characters plus a separator
+        const size_t row_max = (out.columns.size() + 3) * 32;
+        if (out.buffer.size() - out.used < row_max) {
+            flush(out);
+            if (out.buffer.size() < row_max) out.buffer.resize(row_max);
+        }
+
+        char *p = out.buffer.data() + out.used;
+        char *end = out.buffer.data() + out.buffer.size();
+        for (const Column &c: out.columns) {
+            p = Config::visit_field(c.ty, r.data + c.offset, [p, end](auto v) {
+                return format_value(p, end, v);
+            });
+            *p++ = ',';
+        }
+        p = std::to_chars(p, end, r.unix_time).ptr;
+        *p++ = ',';
+        p = std::to_chars(p, end, r.car_timestamp).ptr;
+        *p++ = ',';
+        p = std::to_chars(p, end, r.host_monotonic_ns).ptr;
+        *p++ = '\n';
+        out.used = p - out.buffer.data();
+    }
+
+    void Logger::flush(Output &out) {
+        if (!out.file || !out.used) return;
+        if (fwrite(out.buffer.data(), 1, out.used, out.file) != out.used) {
+            std::cerr << "Logger: write to " << out.name << ".csv failed\n";
+        }
+        out.used = 0;
+    }
+
+    void Logger::flush_all() {
+        session.flush();
+        for (Output &out: outputs) {
+            flush(out);
+        }
+    }
+
+    void Logger::close_all() {
+        session.close();
+        columns.reset();
+        for (Output &out: outputs) {
+            flush(out);
+            if (out.file) {
+                fclose(out.file);
+                out.file = nullptr;
+            }
+        }
+        outputs.clear();
+    }
+} // DS
@@ -0,0 +1,149 @@
+/* date = October 17, 2026 7:40 PM */
+
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ColumnStore.h"
+#include "Config.h"
+#include "SessionLog.h"
+#include "SPSCQueue.h"
+#include "common.h"
+
+namespace DS {
+    /**
+     * Writes one CSV file per config buffer from a background thread, one row per received packet. The same packets
+     * also go, unformatted, into a binary `session.dslog` next to the CSVs (see SessionLog.h), and field by field into
+     * the compressed column store under `columns/` (see ColumnStore.h).
+     *
+     * Producers only copy a fixed-size record into a lock-free queue; the writer thread formats rows into large
+     * per-file buffers and writes them out when a buffer fills or `LOG_FLUSH_INTERVAL_MS` passes. Files stay open
+     * for the whole session. The writer keeps its own copy of the buffer layouts, so it never touches the live
+     * Config.
+     */
+    class Logger {
+    public:
+        /**
+         * One row to log: the raw bytes of a received packet and when it arrived.
+         */
+        struct Record {
+            // message id the packet arrived with, mapped to a buffer of the config by the writer
+            uint8_t type;
+            // the car's own clock, `BufferParser::Buffer::timestamp`
+            int32_t car_timestamp;
+            // host steady_clock nanoseconds, `BufferParser::Buffer::received_ns`
+            int64_t host_monotonic_ns;
+            int64_t unix_time;
+            uint8_t data[MSG_LENGTH];
+            // set by `log`: which `open` call the row belongs to
+            uint32_t generation;
+        };
+
+        Logger();
+        ~Logger();
+
+        Logger(const Logger &) = delete;
+        Logger &operator=(const Logger &) = delete;
+
+        /**
+         * Starts a new set of log files, one `<buffer name>.csv` per buffer in `config` plus `session.dslog`, inside
+         * `directory`. Files of
+         * the previous config are flushed and closed first. The directory is created by the writer thread.
+         * @param config Config whose layout rows will follow.
+         * @param directory Where to put the files.
+         */
+        void open(const Config &config, const std::filesystem::path &directory);
+
+        /**
+         * Stops logging after everything queued so far is written.
+         */
+        void close();
+
+        /**
+         * Queues a row. Never blocks.
+         * NOTE: only one thread may call this.
+         * @return false if the queue was full and the row was dropped.
+         */
+        bool log(Record record) {
+            record.generation = generation.load(std::memory_order_acquire);
+            return queue.push(record);
+        }
+
+        /**
+         * @return Rows dropped because the writer fell behind.
+         */
+        [[nodiscard]] uint64_t dropped() const {
+            return queue.overflows();
+        }
+
+    private:
+        struct Column {
+            uint32_t offset;
+            Config::FieldType ty;
+        };
+
+        // one buffer's file and layout
+        struct Output {
+            std::string name;
+            std::vector<std::string> header;
+            std::vector<Column> columns;
+            size_t size{};
+            FILE *file = nullptr;
+            std::vector<char> buffer;
+            size_t used = 0;
+        };
+
+        struct Schema {
+            uint32_t generation;
+            // empty when logging was closed
+            std::optional<std::filesystem::path> directory;
+            std::vector<Output> outputs;
+            // SessionWriter::encode_header of the config
+            std::vector<uint8_t> session_header;
+            std::vector<ColumnStore::BufferLayout> column_layout;
+            // message id -> index into `outputs`, -1 for ids the config doesn't define
+            std::array<int32_t, 256> by_type;
+        };
+
+        void submit(Schema schema);
+        void run();
+        void apply_pending();
+        void write(const Record &r);
+        void flush(Output &out);
+        void flush_all();
+        void close_all();
+
+        SPSCQueue<Record, LOG_QUEUE_CAPACITY> queue;
+
+        // bumped by every open/close; rows from an older generation than the active one are dropped
+        std::atomic<uint32_t> generation{0};
+
+        // hand-off of a new schema from open/close to the writer
+        std::mutex pending_lock;
+        std::optional<Schema> pending;
+        std::atomic<bool> has_pending{false};
+
+        // owned by the writer thread
+        std::vector<Output> outputs;
+        std::array<int32_t, 256> by_type{};
+        SessionWriter session;
+        std::unique_ptr<ColumnStore> columns;
+        uint32_t active_generation = 0;
+
+        std::atomic<bool> stopping{false};
+        std::thread writer;
+    };
+} // DS
+
+#endif //LOGGER_H
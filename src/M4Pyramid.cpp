@@ -0,0 +1,109 @@
+/* date = October 17, 2026 6:20 PM */
+
+
+#include "M4Pyramid.h"
+
+#include <algorithm>
+
+namespace DS {
+    // most points per pixel before a coarser level is used; M4 needs up to 4 to be lossless
+    static constexpr double POINTS_PER_PIXEL = 4.0;
+
+    M4Pyramid::M4Pyramid(const size_t capacity) {
+        size_t size = 1;
+        for (size_t k = 0; k < LEVELS; k++) {
+            size *= FACTOR;
+            bucket_size[k] = size;
+            levels.emplace_back(std::max<size_t>(capacity / 2, 1024));
+        }
+    }
+
+    void M4Pyramid::push(const double x, const double y) {
+        for (size_t k = 0; k < LEVELS; k++) {
+            Bucket &b = buckets[k];
+            if (b.count == 0) {
+                b.first_x = b.min_x = b.max_x = x;
+                b.first_y = b.min_y = b.max_y = y;
+                b.min_i = b.max_i = 0;
+            } else {
+                if (y < b.min_y) {
+                    b.min_x = x;
+                    b.min_y = y;
+                    b.min_i = b.count;
+                }
+                if (y > b.max_y) {
+                    b.max_x = x;
+                    b.max_y = y;
+                    b.max_i = b.count;
+                }
+            }
+            b.last_x = x;
+            b.last_y = y;
+
+            if (++b.count == bucket_size[k]) {
+                emit(b, [&](const double px, const double py) { levels[k].push(px, py); });
+                b.count = 0;
+            }
+        }
+    }
+
+    template<typename F>
+    void M4Pyramid::emit(const Bucket &b, F &&f) {
+        // first and last bound the bucket; min and max go in between in the order they happened
+        f(b.first_x, b.first_y);
+        const bool min_first = b.min_i <= b.max_i;
+        const size_t mid_i[2] = {min_first ? b.min_i : b.max_i, min_first ? b.max_i : b.min_i};
+        const double mid_x[2] = {min_first ? b.min_x : b.max_x, min_first ? b.max_x : b.min_x};
+        const double mid_y[2] = {min_first ? b.min_y : b.max_y, min_first ? b.max_y : b.min_y};
+        for (int j = 0; j < 2; j++) {
+            // skip points that are the first/last sample, or the same sample twice
+            if (mid_i[j] == 0 || mid_i[j] == b.count - 1) continue;
+            if (j == 1 && mid_i[1] == mid_i[0]) continue;
+            f(mid_x[j], mid_y[j]);
+        }
+        if (b.count > 1) {
+            f(b.last_x, b.last_y);
+        }
+    }
+
+    void M4Pyramid::clear() {
+        for (RingSeries &level: levels) {
+            level.clear();
+        }
+        buckets.fill({});
+    }
+
+    // 0 for the raw series, otherwise the level number plus one
+    size_t M4Pyramid::select(const RingSeries &raw, const double x_min, const double x_max,
+                             const double pixels) const {
+        const double budget = std::max(pixels, 1.0) * POINTS_PER_PIXEL;
+        for (size_t k = 0; k < LEVELS; k++) {
+            const RingSeries &s = k == 0 ? raw : levels[k - 1];
+            if (s.empty()) continue;
+
+            // a level that has already dropped part of the window would cut the plot short
+            const bool covers = s.xs().front() <= x_min || s.size() < s.capacity();
+            const size_t visible = s.lower_bound(x_max) - s.lower_bound(x_min);
+            if (covers && static_cast<double>(visible) <= budget) return k;
+        }
+        return LEVELS;
+    }
+
+    M4Pyramid::View M4Pyramid::visible(const RingSeries &raw, const double x_min, const double x_max,
+                                       const double pixels) const {
+        const size_t k = select(raw, x_min, x_max, pixels);
+        const RingSeries &s = k == 0 ? raw : levels[k - 1];
+        const size_t first = s.lower_bound(x_min);
+        const auto xs = s.xs().subspan(first);
+        const auto ys = s.ys().subspan(first);
+        if (k == 0 || buckets[k - 1].count == 0) return {xs, ys};
+
+        view_x.assign(xs.begin(), xs.end());
+        view_y.assign(ys.begin(), ys.end());
+        emit(buckets[k - 1], [this](const double px, const double py) {
+            view_x.push_back(px);
+            view_y.push_back(py);
+        });
+        return {view_x, view_y};
+    }
+} // DS
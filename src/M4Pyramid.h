@@ -0,0 +1,83 @@
+/* date = October 17, 2026 6:20 PM */
+
+
+#ifndef M4PYRAMID_H
+#define M4PYRAMID_H
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "RingSeries.h"
+
+namespace DS {
+    /**
+     * Multi-resolution copy of a series for plotting long windows.
+     *
+     * Level k groups every FACTOR^(k+1) consecutive samples into a bucket and keeps only the first, smallest, largest
+     * and last sample of it (M4 decimation). Drawn as a line, a bucket then looks the same as its raw samples at one
+     * pixel wide, so spikes survive. Levels are updated as samples arrive, and each one keeps its own ring, so
+     * coarse levels reach much further back than the raw history.
+     */
+    class M4Pyramid {
+    public:
+        static constexpr size_t LEVELS = 4;
+        static constexpr size_t FACTOR = 8;
+
+        /**
+         * @param capacity Capacity of the raw series. Each level keeps half as many points.
+         */
+        explicit M4Pyramid(size_t capacity);
+
+        void push(double x, double y);
+        void clear();
+
+        /**
+         * Points to draw for a window, as contiguous columns.
+         */
+        struct View {
+            std::span<const double> xs;
+            std::span<const double> ys;
+        };
+
+        /**
+         * Picks the finest series that can draw `[x_min, x_max]` with at most a few points per pixel, and returns
+         * its points from `x_min` on. When a level is picked, the bucket it is still filling is appended too, so the
+         * right edge keeps up with `raw` instead of lagging by up to a bucket.
+         * @param raw Undecimated series, used when it is fine enough and reaches back far enough.
+         * @param x_min Left edge of the plot.
+         * @param x_max Right edge of the plot.
+         * @param pixels Width of the plot in pixels.
+         * @return Points of `raw` or of one of the levels; valid until the next `push`, `clear` or `visible`.
+         */
+        [[nodiscard]] View visible(const RingSeries &raw, double x_min, double x_max, double pixels) const;
+
+    private:
+        // partially filled bucket of one level
+        struct Bucket {
+            size_t count = 0;
+            double first_x{}, first_y{};
+            double last_x{}, last_y{};
+            double min_x{}, min_y{};
+            double max_x{}, max_y{};
+            // position in the bucket, to emit points in x order
+            size_t min_i{}, max_i{};
+        };
+
+        // calls `f(x, y)` for the bucket's points, in x order
+        template<typename F>
+        static void emit(const Bucket &b, F &&f);
+
+        [[nodiscard]] size_t select(const RingSeries &raw, double x_min, double x_max, double pixels) const;
+
+        std::vector<RingSeries> levels;
+        std::array<Bucket, LEVELS> buckets{};
+        std::array<size_t, LEVELS> bucket_size{};
+        // a level's visible points followed by its open bucket, since the ring has no room after its newest point
+        mutable std::vector<double> view_x;
+        mutable std::vector<double> view_y;
+    };
+} // DS
+
+#endif //M4PYRAMID_H
@@ -0,0 +1,143 @@
+/* date = October 18, 2026 12:20 AM */
+
+
+#include "MapView.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "imgui.h"
+
+namespace DS {
+    // zoom levels per notch of the mouse wheel
+    static constexpr double MAP_WHEEL_ZOOM = 0.25;
+    // lower zoom levels searched for a cached tile to stand in for one that is still loading
+    static constexpr int MAP_STAND_IN_LEVELS = 4;
+    static constexpr float MAP_MIN_SIZE = 64.0f;
+    static constexpr float MAP_TRACK_WIDTH = 3.0f;
+
+    void MapView::draw(const double lon, const double lat, const GpsTrack &track) {
+        tiles.upload();
+
+        ImGui::Checkbox("Follow car", &follow);
+        ImGui::SameLine();
+        ImGui::Text("Zoom: %.2f", zoom);
+
+        const double car_x = lon_to_tile(lon, 0);
+        const double car_y = lat_to_tile(lat, 0);
+        if (follow) {
+            center_x = car_x;
+            center_y = car_y;
+        }
+
+        ImVec2 size = ImGui::GetContentRegionAvail();
+        size.x = std::max(size.x, MAP_MIN_SIZE);
+        size.y = std::max(size.y, MAP_MIN_SIZE);
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImGui::InvisibleButton("map", size);
+        const ImGuiIO &io = ImGui::GetIO();
+
+        // pixels across the whole world at the current zoom
+        double world = TILE_SIZE * std::exp2(zoom);
+        if (ImGui::IsItemHovered() && io.MouseWheel != 0) {
+            // keep the point under the cursor in place, or the car in the middle when following it
+            const double mx = follow ? 0 : io.MousePos.x - (origin.x + size.x / 2);
+            const double my = follow ? 0 : io.MousePos.y - (origin.y + size.y / 2);
+            const double px = center_x + mx / world;
+            const double py = center_y + my / world;
+            zoom = std::clamp(zoom + io.MouseWheel * MAP_WHEEL_ZOOM, 0.0, static_cast<double>(MAX_ZOOM));
+            world = TILE_SIZE * std::exp2(zoom);
+            center_x = px - mx / world;
+            center_y = py - my / world;
+        }
+        if (ImGui::IsItemActive() && ImGui::IsMouseDragging(0)) {
+            center_x -= io.MouseDelta.x / world;
+            center_y -= io.MouseDelta.y / world;
+            follow = false;
+        }
+        center_x -= std::floor(center_x);
+        center_y = std::clamp(center_y, 0.0, 1.0);
+
+        // tiles of the nearest whole zoom level, scaled by at most a factor of sqrt(2) either way
+        const int z = std::clamp(static_cast<int>(std::lround(zoom)), 0, MAX_ZOOM);
+        const int n = 1 << z;
+        const double tile_px = world / n;
+        const double left = center_x * world - size.x / 2;
+        const double top = center_y * world - size.y / 2;
+
+        ImDrawList *list = ImGui::GetWindowDrawList();
+        list->PushClipRect(origin, ImVec2(origin.x + size.x, origin.y + size.y), true);
+        for (int ty = std::max(0, static_cast<int>(std::floor(top / tile_px))); ty < n && ty * tile_px < top + size.y;
+             ty++) {
+            for (int tx = static_cast<int>(std::floor(left / tile_px)); tx * tile_px < left + size.x; tx++) {
+                const ImVec2 p0(origin.x + static_cast<float>(tx * tile_px - left),
+                                origin.y + static_cast<float>(ty * tile_px - top));
+                const ImVec2 p1(p0.x + static_cast<float>(tile_px), p0.y + static_cast<float>(tile_px));
+                // the map wraps around at the antimeridian
+                const int x = (tx % n + n) % n;
+
+                // the part of the texture to show: all of it, or this tile's share of a lower zoom tile
+                std::optional<TileTexture> tex = tiles.get({z, x, ty});
+                double part_x = 0, part_y = 0, part = 1;
+                for (int k = 1; !tex && k <= std::min(MAP_STAND_IN_LEVELS, z); k++) {
+                    tex = tiles.peek({z - k, x >> k, ty >> k});
+                    part = 1.0 / (1 << k);
+                    part_x = (x & ((1 << k) - 1)) * part;
+                    part_y = (ty & ((1 << k) - 1)) * part;
+                }
+                if (!tex) {
+                    list->AddRectFilled(p0, p1, IM_COL32(220, 220, 220, 255));
+                    continue;
+                }
+
+                // half a texel in from the edges, so filtering doesn't pick up the next slot of the atlas
+                const float inset = tex->texel / 2;
+                const double du = tex->u1 - tex->u0;
+                const double dv = tex->v1 - tex->v0;
+                const ImVec2 uv0(static_cast<float>(tex->u0 + du * part_x) + inset,
+                                 static_cast<float>(tex->v0 + dv * part_y) + inset);
+                const ImVec2 uv1(static_cast<float>(tex->u0 + du * (part_x + part)) - inset,
+                                 static_cast<float>(tex->v0 + dv * (part_y + part)) - inset);
+                list->AddImage(static_cast<ImTextureID>(tex->texture), p0, p1, uv0, uv1);
+            }
+        }
+
+        // the track, only the chunks in view and only as detailed as this zoom can show. unlike the tiles, it isn't
+        // repeated across the antimeridian
+        const auto to_track_units = [](const double v) {
+            return static_cast<uint32_t>(std::clamp(v * TRACK_SCALE, 0.0, TRACK_SCALE - 1));
+        };
+        const TrackBounds view{to_track_units(left / world), to_track_units(top / world),
+                               to_track_units((left + size.x) / world), to_track_units((top + size.y) / world)};
+        const double track_px = world / TRACK_SCALE;
+        const auto flush = [&] {
+            if (track_line.size() > 1) {
+                list->AddPolyline(track_line.data(), static_cast<int>(track_line.size()), IM_COL32(30, 90, 220, 255),
+                                  ImDrawFlags_None, MAP_TRACK_WIDTH);
+            }
+            track_line.clear();
+        };
+        uint32_t line_end = UINT32_MAX;
+        track.for_each_run(std::clamp(static_cast<int>(std::ceil(zoom)), 0, MAX_ZOOM), view,
+                           [&](const std::span<const uint32_t> run) {
+                               // a run carrying on from the last one extends its line, so the join is drawn properly
+                               if (run.front() != line_end) flush();
+                               for (size_t i = track_line.empty() ? 0 : 1; i < run.size(); i++) {
+                                   const TrackPoint &p = track[run[i]];
+                                   track_line.emplace_back(origin.x + static_cast<float>(p.x * track_px - left),
+                                                           origin.y + static_cast<float>(p.y * track_px - top));
+                               }
+                               line_end = run.back();
+                           });
+        flush();
+
+        // the car, on whichever copy of the world is nearest the middle
+        double dx = car_x - center_x;
+        dx -= std::round(dx);
+        const ImVec2 car(origin.x + size.x / 2 + static_cast<float>(dx * world),
+                         origin.y + size.y / 2 + static_cast<float>((car_y - center_y) * world));
+        list->AddCircleFilled(car, 6.0f, IM_COL32(255, 255, 255, 255));
+        list->AddCircleFilled(car, 4.0f, IM_COL32(220, 40, 40, 255));
+        list->PopClipRect();
+    }
+} // DS
@@ -0,0 +1,59 @@
+/* date = October 18, 2026 12:20 AM */
+
+
+#ifndef MAPVIEW_H
+#define MAPVIEW_H
+
+#include <vector>
+
+#include "imgui.h"
+
+#include "GenerateMap.h"
+#include "GpsTrack.h"
+#include "TileWorker.h"
+
+namespace DS {
+    /**
+     * The map widget: fills the rest of the current ImGui window with tiles around a point, with mouse pan (drag) and
+     * zoom (wheel), or follows the car. The car's track is drawn on top.
+     *
+     * Tiles are drawn straight from TileWorker's atlases as textured quads, so a frame costs a few quads and a draw
+     * call per atlas page; nothing is stitched or uploaded unless a new tile arrives. While a tile loads, a cached
+     * tile from a lower zoom stands in for it, so zooming never shows blank squares for long.
+     *
+     * NOTE: like TileWorker, create, draw and destroy it on the UI thread with the GL context current.
+     */
+    class MapView {
+    public:
+        MapView() = default;
+
+        /**
+         * Draws the map and handles its input. Call between ImGui::Begin and ImGui::End.
+         * @param lon Longitude of the car.
+         * @param lat Latitude of the car.
+         * @param track Where the car has been.
+         */
+        void draw(double lon, double lat, const GpsTrack &track);
+
+        /**
+         * @return Whether a tile failed to load recently, most likely because there is no internet.
+         */
+        [[nodiscard]] bool failing() const {
+            return tiles.failing();
+        }
+
+    private:
+        TileWorker tiles;
+
+        // middle of the view, in Web Mercator coordinates scaled to [0, 1) across the world
+        double center_x = 0.5;
+        double center_y = 0.5;
+        // fractional, for smooth zooming; tiles come from the nearest whole level
+        double zoom = ZOOM;
+        bool follow = true;
+        // screen positions of the part of the track being drawn, kept to reuse its memory
+        std::vector<ImVec2> track_line;
+    };
+} // DS
+
+#endif //MAPVIEW_H
@@ -0,0 +1,99 @@
+/* date = October 17, 2026 8:50 PM */
+
+
+#include "MappedFile.h"
+
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace DS {
+    std::optional<MappedFile> MappedFile::open(const std::filesystem::path &path) {
+        MappedFile file;
+#ifdef _WIN32
+        file.file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                       OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file.file_handle == INVALID_HANDLE_VALUE) {
+            file.file_handle = nullptr;
+            std::cerr << "MappedFile: could not open " << path << "\n";
+            return std::nullopt;
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(file.file_handle, &size);
+        file.length = static_cast<size_t>(size.QuadPart);
+        if (file.length) {
+            file.mapping_handle = CreateFileMappingW(file.file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (file.mapping_handle) {
+                file.base = static_cast<const uint8_t *>(MapViewOfFile(file.mapping_handle, FILE_MAP_READ, 0, 0, 0));
+            }
+        }
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "MappedFile: could not open " << path << "\n";
+            return std::nullopt;
+        }
+        struct stat st{};
+        fstat(fd, &st);
+        file.length = static_cast<size_t>(st.st_size);
+        if (file.length) {
+            void *p = mmap(nullptr, file.length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                file.base = static_cast<const uint8_t *>(p);
+                // everything that maps files here reads them front to back
+                madvise(p, file.length, MADV_SEQUENTIAL);
+            }
+        }
+        // the mapping stays valid after the descriptor is closed
+        ::close(fd);
+#endif
+        if (!file.base) {
+            std::cerr << "MappedFile: could not map " << path << "\n";
+            return std::nullopt;
+        }
+        return file;
+    }
+
+    MappedFile::~MappedFile() {
+        unmap();
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this == &other) return *this;
+        unmap();
+        base = std::exchange(other.base, nullptr);
+        length = std::exchange(other.length, 0);
+#ifdef _WIN32
+        file_handle = std::exchange(other.file_handle, nullptr);
+        mapping_handle = std::exchange(other.mapping_handle, nullptr);
+#endif
+        return *this;
+    }
+
+    void MappedFile::unmap() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping_handle) CloseHandle(mapping_handle);
+        if (file_handle) CloseHandle(file_handle);
+        mapping_handle = nullptr;
+        file_handle = nullptr;
+#else
+        if (base) munmap(const_cast<uint8_t *>(base), length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+} // DS
@@ -0,0 +1,59 @@
+/* date = October 17, 2026 8:50 PM */
+
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+namespace DS {
+    /**
+     * A whole file mapped read-only into memory (mmap, or a file mapping on Windows). Move-only; the mapping is
+     * released when the object is destroyed.
+     */
+    class MappedFile {
+    public:
+        /**
+         * Errors are printed.
+         * @param path File to map.
+         * @return The mapping, or std::nullopt if the file can't be opened or is empty.
+         */
+        static std::optional<MappedFile> open(const std::filesystem::path &path);
+
+        ~MappedFile();
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        [[nodiscard]] const uint8_t *data() const {
+            return base;
+        }
+
+        [[nodiscard]] size_t size() const {
+            return length;
+        }
+
+        [[nodiscard]] std::span<const uint8_t> bytes() const {
+            return {base, length};
+        }
+
+    private:
+        MappedFile() = default;
+
+        void unmap();
+
+        const uint8_t *base = nullptr;
+        size_t length = 0;
+#ifdef _WIN32
+        void *file_handle = nullptr;
+        void *mapping_handle = nullptr;
+#endif
+    };
+} // DS
+
+#endif //MAPPEDFILE_H
@@ -346,6 +346,8 @@ poly_eval(const Poly *p, uint16_t x) {
 #include <string.h>
 #include <stdint.h>
 
+#include "RS-SIMD.h"
+
 #if !defined DEBUG && !defined __CC_ARM
 #include <assert.h>
 #else
@@ -401,52 +403,14 @@ public:
      void EncodeBlock(const void* src, void* dst) {
         assert(msg_length + ecc_length < 256);
 
-        /* Generator cache, it dosn't change for one template parameters */
-        static uint8_t generator_cache[ecc_length+1] = {0};
-        static bool    generator_cached = false;
-
-        /* Allocating memory on stack for polynomials storage */
-        uint8_t stack_memory[MSG_CNT * msg_length + POLY_CNT * ecc_length * 2];
-        this->memory = stack_memory;
-
-        const uint8_t* src_ptr = (const uint8_t*) src;
-        uint8_t* dst_ptr = (uint8_t*) dst;
-
-        Poly *msg_in  = &polynoms[ID_MSG_IN];
-        Poly *msg_out = &polynoms[ID_MSG_OUT];
-        Poly *gen     = &polynoms[ID_GENERATOR];
-
-        // Weird shit, but without reseting msg_in it simply doesn't work
-        msg_in->Reset();
-        msg_out->Reset();
-
-        // Using cached generator or generating new one
-        if(generator_cached) {
-            gen->Set(generator_cache, sizeof(generator_cache));
-        } else {
-            GeneratorPoly();
-            memcpy(generator_cache, gen->ptr(), gen->length);
-            generator_cached = true;
-        }
-
-        // Copying input message to internal polynomial
-        msg_in->Set(src_ptr, msg_length);
-        msg_out->Set(src_ptr, msg_length);
-        msg_out->length = msg_in->length + ecc_length;
-
-        // Here all the magic happens
-        uint8_t coef = 0; // cache
-        for(uint8_t i = 0; i < msg_length; i++){
-            coef = msg_out->at(i);
-            if(coef != 0){
-                for(uint32_t j = 1; j < gen->length; j++){
-                    msg_out->at(i+j) ^= gf::mul(gen->at(j), coef);
-                }
-            }
-        }
+        simd::encode(GeneratorTable(), (const uint8_t*) src, msg_length, (uint8_t*) dst);
+    }
 
-        // Copying ECC to the output buffer
-        memcpy(dst_ptr, msg_out->ptr()+msg_length, ecc_length * sizeof(uint8_t));
+    /* @brief Generator product table used by EncodeBlock
+     * It dosn't change for one template parameters, so it's built once */
+    static const simd::EncodeTable& GeneratorTable() {
+        static const simd::EncodeTable table = MakeEncodeTable();
+        return table;
     }
 
     /* @brief Message encoding
@@ -462,6 +426,56 @@ public:
         EncodeBlock(src, dst_ptr+msg_length);
     }
 
+    /* @brief Result of Correct() */
+    enum DecodeStatus {
+        DECODE_CLEAN = 0,   // all syndromes were zero, message copied as is
+        DECODE_CORRECTED,   // errors found and corrected
+        DECODE_FAILED       // too many errors to correct
+    };
+
+    /* @brief Syndrome calculation, vectorized when the CPU allows (see simd::frame_syndromes)
+     * @param *src  - encoded message buffer   (msg_length + ecc_length size)
+     * @param *synd - output syndromes         (ecc_length size)
+     * @return true if every syndrome is zero, i.e. the message has no detectable errors */
+    bool Syndromes(const void* src, uint8_t* synd) const {
+        return !simd::frame_syndromes((const uint8_t*) src, msg_length + ecc_length, ecc_length, synd);
+    }
+
+    /* @brief Syndrome-only check of an encoded message
+     * @param *src - encoded message buffer   (msg_length + ecc_length size)
+     * @return true if the message has no detectable errors */
+    bool Check(const void* src) const {
+        uint8_t synd[ecc_length];
+        return Syndromes(src, synd);
+    }
+
+    /* @brief Message decoding with an early exit for clean messages
+     * Clean messages cost one syndrome pass and a copy. Otherwise the full
+     * decoder runs and its result is re-encoded, so a miscorrection that moves
+     * more symbols than the code can fix is reported as a failure.
+     * @param *src - encoded message buffer   (msg_length + ecc_length size)
+     * @param *dst - output buffer            (msg_length + ecc_length size at least)
+     * @return DECODE_CLEAN, DECODE_CORRECTED or DECODE_FAILED */
+    DecodeStatus Correct(const void* src, void* dst) {
+        const uint8_t* src_ptr = (const uint8_t*) src;
+        uint8_t* dst_ptr = (uint8_t*) dst;
+
+        if(Check(src_ptr)) {
+            memcpy(dst_ptr, src_ptr, msg_length + ecc_length);
+            return DECODE_CLEAN;
+        }
+
+        if(Decode(src_ptr, dst_ptr) != 0) return DECODE_FAILED;
+        EncodeBlock(dst_ptr, dst_ptr + msg_length);
+
+        uint8_t moved = 0;
+        for(uint8_t i = 0; i < msg_length + ecc_length; i++) {
+            moved += dst_ptr[i] != src_ptr[i];
+        }
+        if(moved > ecc_length / 2) return DECODE_FAILED;
+        return DECODE_CORRECTED;
+    }
+
     /* @brief Message block decoding
      * @param *src         - encoded message buffer   (msg_length size)
      * @param *ecc         - ecc buffer               (ecc_length size)
@@ -482,7 +496,7 @@ public:
         bool ok;
 
         /* Allocation memory on stack */
-        uint8_t stack_memory[MSG_CNT * msg_length + POLY_CNT * ecc_length * 2];
+        uint8_t stack_memory[MSG_CNT * (msg_length + ecc_length) + POLY_CNT * ecc_length * 2];
         this->memory = stack_memory;
 
         Poly *msg_in  = &polynoms[ID_MSG_IN];
@@ -606,6 +620,23 @@ private:
     uint8_t* memory{};
     Poly polynoms[MSG_CNT + POLY_CNT];
 
+    static_assert(ecc_length <= 16, "table-driven encoder holds at most 16 ecc symbols");
+
+    /* @brief Generator polynomial times every possible feedback byte, see simd::encode */
+    static simd::EncodeTable MakeEncodeTable() {
+        uint8_t gen[ecc_length + 1] = {1};
+        for(uint8_t i = 0; i < ecc_length; i++) {
+            const uint8_t a = gf::pow(2, i);
+            for(uint8_t j = i + 1; j > 0; j--) {
+                gen[j] ^= gf::mul(gen[j-1], a);
+            }
+        }
+
+        simd::EncodeTable table{};
+        simd::build_encode_table(gen, ecc_length, &table);
+        return table;
+    }
+
     void GeneratorPoly() {
         Poly *gen = polynoms + ID_GENERATOR;
         gen->at(0) = 1;
@@ -626,12 +657,11 @@ private:
     }
 
     void CalcSyndromes(const Poly *msg) {
+        assert(msg->length == msg_length + ecc_length);
         Poly *synd = &polynoms[ID_SYNDROMES];
         synd->length = ecc_length+1;
         synd->at(0) = 0;
-        for(uint8_t i = 1; i < ecc_length+1; i++){
-            synd->at(i) = gf::poly_eval(msg, gf::pow(2, i-1));
-        }
+        Syndromes(msg->ptr(), synd->ptr() + 1);
     }
 
     void FindErrataLocator(const Poly *epos) {
@@ -822,10 +852,12 @@ private:
         uint8_t errs = error_loc->length - 1;
         err->length = 0;
 
-        for(uint8_t i = 0; i < msg_in_size; i++) {
-            if(gf::poly_eval(error_loc, gf::pow(2, i)) == 0) {
-                err->Append(msg_in_size - 1 - i);
-            }
+        uint8_t roots[256];
+        const size_t found = simd::chien_search(error_loc->ptr(), error_loc->length, msg_in_size, roots);
+        if(found != errs) return false;
+
+        for(size_t r = 0; r < found; r++) {
+            err->Append(msg_in_size - 1 - roots[r]);
         }
 
         /* Sanity check:
@@ -0,0 +1,467 @@
+/* date = October 17, 2026 9:10 AM */
+
+
+#include "RS-SIMD.h"
+
+#include <cstring>
+
+#include "RS-FEC.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RS_SIMD_X86 1
+#include <immintrin.h>
+#define RS_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace RS {
+
+namespace simd {
+
+/* ##################
+ * # SHARED TABLES  #
+ * ################## */
+
+/* @brief Multiplication by x in GF(256), 0x11d primitive polynomial */
+static inline uint8_t xtime(uint8_t v) {
+    return (uint8_t) ((v << 1) ^ ((v & 0x80) ? 0x1d : 0));
+}
+
+/* @brief Nibble tables for multiplication by a constant
+ * c * v == lo[v & 0xf] ^ hi[v >> 4] */
+struct NibbleTable {
+    alignas(16) uint8_t lo[16];
+    alignas(16) uint8_t hi[16];
+};
+
+static void make_nibble_table(uint8_t c, NibbleTable* t) {
+    uint8_t pw[8];
+    pw[0] = c;
+    for(int b = 1; b < 8; b++) pw[b] = xtime(pw[b-1]);
+
+    t->lo[0] = 0;
+    t->hi[0] = 0;
+    for(int x = 1; x < 16; x++) {
+        const int low_bit = __builtin_ctz(x);
+        t->lo[x] = t->lo[x & (x - 1)] ^ pw[low_bit];
+        t->hi[x] = t->hi[x & (x - 1)] ^ pw[low_bit + 4];
+    }
+}
+
+/* Nibble tables for alpha^k, used by the syndrome Horner loop */
+struct AlphaTables {
+    NibbleTable alpha[255];
+
+    AlphaTables() {
+        for(int k = 0; k < 255; k++) make_nibble_table(gf::exp[k], &alpha[k]);
+    }
+};
+
+static const AlphaTables& alpha_tables() {
+    static const AlphaTables tables;
+    return tables;
+}
+
+/* Nibble tables for every constant, used to scale a vector by one symbol */
+struct ScaleTables {
+    NibbleTable by[256];
+
+    ScaleTables() {
+        for(int c = 0; c < 256; c++) make_nibble_table((uint8_t) c, &by[c]);
+    }
+};
+
+static const ScaleTables& scale_tables() {
+    static const ScaleTables tables;
+    return tables;
+}
+
+/* weights[e][k] = alpha^(k*e): what a symbol e places from the end of the
+ * frame is multiplied by in syndrome k, for the single-frame kernel */
+struct WeightTables {
+    alignas(16) uint8_t weights[255][16];
+
+    WeightTables() {
+        for(int e = 0; e < 255; e++) {
+            for(int k = 0; k < 16; k++) weights[e][k] = gf::exp[(k * e) % 255];
+        }
+    }
+};
+
+static const WeightTables& weight_tables() {
+    static const WeightTables tables;
+    return tables;
+}
+
+/* powers[d][i] = alpha^(i*d), used by Chien search. Rows are padded so a
+ * full-width load starting at any position below 255 stays inside its row. */
+static constexpr int MAX_LOC_LENGTH = 33;
+static constexpr int POWER_ROW = 288;
+
+struct PowerTables {
+    alignas(32) uint8_t powers[MAX_LOC_LENGTH][POWER_ROW];
+
+    PowerTables() {
+        for(int d = 0; d < MAX_LOC_LENGTH; d++) {
+            for(int i = 0; i < POWER_ROW; i++) powers[d][i] = gf::exp[(i * d) % 255];
+        }
+    }
+};
+
+static const PowerTables& power_tables() {
+    static const PowerTables tables;
+    return tables;
+}
+
+/* ############
+ * # DISPATCH #
+ * ############ */
+
+static Isa detect_isa() {
+#ifdef RS_SIMD_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return ISA_AVX2;
+    if(__builtin_cpu_supports("ssse3")) return ISA_SSSE3;
+#endif
+    return ISA_SCALAR;
+}
+
+Isa best_isa() {
+    static const Isa isa = detect_isa();
+    return isa;
+}
+
+const char* isa_name(Isa isa) {
+    switch(isa) {
+        case ISA_SCALAR: return "scalar";
+        case ISA_SSSE3:  return "ssse3";
+        case ISA_AVX2:   return "avx2";
+    }
+    return "unknown";
+}
+
+/* Never run a kernel the CPU can't execute, whatever the caller asked for */
+static Isa clamp_isa(Isa isa) {
+    return isa > best_isa() ? best_isa() : isa;
+}
+
+/* ##########
+ * # ENCODE #
+ * ########## */
+
+void build_encode_table(const uint8_t* generator, uint8_t ecc_length, EncodeTable* table) {
+    assert(ecc_length <= 16);
+    memset(table, 0, sizeof(*table));
+    table->ecc_length = ecc_length;
+    for(int c = 0; c < 256; c++) {
+        for(uint8_t j = 0; j < ecc_length; j++) {
+            table->rows[c][j] = gf::mul(generator[j+1], c);
+        }
+    }
+}
+
+static void encode_scalar(const EncodeTable& table, const uint8_t* msg, size_t msg_length, uint8_t* ecc) {
+    uint8_t p[17] = {0};
+    for(size_t i = 0; i < msg_length; i++) {
+        const uint8_t* row = table.rows[msg[i] ^ p[0]];
+        for(uint8_t j = 0; j < table.ecc_length; j++) {
+            p[j] = p[j+1] ^ row[j];
+        }
+    }
+    memcpy(ecc, p, table.ecc_length);
+}
+
+#ifdef RS_SIMD_X86
+RS_TARGET("ssse3")
+static void encode_ssse3(const EncodeTable& table, const uint8_t* msg, size_t msg_length, uint8_t* ecc) {
+    // the whole parity register lives in one vector; shifting it is a single byte shift
+    __m128i p = _mm_setzero_si128();
+    for(size_t i = 0; i < msg_length; i++) {
+        const uint8_t fb = msg[i] ^ (uint8_t) _mm_cvtsi128_si32(p);
+        p = _mm_srli_si128(p, 1);
+        p = _mm_xor_si128(p, _mm_loadu_si128((const __m128i*) table.rows[fb]));
+    }
+    alignas(16) uint8_t out[16];
+    _mm_store_si128((__m128i*) out, p);
+    memcpy(ecc, out, table.ecc_length);
+}
+#endif
+
+void encode(const EncodeTable& table, const uint8_t* msg, size_t msg_length, uint8_t* ecc, Isa isa) {
+#ifdef RS_SIMD_X86
+    if(clamp_isa(isa) >= ISA_SSSE3) {
+        encode_ssse3(table, msg, msg_length, ecc);
+        return;
+    }
+#endif
+    (void) isa;
+    encode_scalar(table, msg, msg_length, ecc);
+}
+
+/* #############
+ * # SYNDROMES #
+ * ############# */
+
+static bool syndromes_scalar(const uint8_t* frame, uint8_t enc_length, uint8_t ecc_length, uint8_t* synd) {
+    memset(synd, 0, ecc_length);
+    for(uint8_t j = 0; j < enc_length; j++) {
+        if(frame[j] == 0) continue;
+        // r_j * alpha^(k*e) for every k, walking the exponent instead of multiplying
+        const uint16_t e = enc_length - 1 - j;
+        uint16_t t = gf::log[frame[j]];
+        for(uint8_t k = 0; k < ecc_length; k++) {
+            synd[k] ^= gf::exp[t];
+            t += e;
+            if(t >= 255) t -= 255;
+        }
+    }
+
+    uint8_t any = 0;
+    for(uint8_t k = 0; k < ecc_length; k++) any |= synd[k];
+    return any != 0;
+}
+
+/* Gathers byte j of `lanes` frames into columns[j], zero-padding missing frames */
+static void transpose(const uint8_t* frames, size_t lanes, size_t width, uint8_t enc_length, uint8_t* columns) {
+    for(uint8_t j = 0; j < enc_length; j++) {
+        uint8_t* col = columns + (size_t) j * width;
+        size_t l = 0;
+        for(; l < lanes; l++) col[l] = frames[l * enc_length + j];
+        for(; l < width; l++) col[l] = 0;
+    }
+}
+
+#ifdef RS_SIMD_X86
+RS_TARGET("ssse3")
+static size_t syndromes_ssse3(const uint8_t* frames, size_t count, uint8_t enc_length, uint8_t ecc_length,
+                              uint8_t* synd) {
+    constexpr size_t WIDTH = 16;
+    alignas(16) uint8_t columns[255 * WIDTH];
+    alignas(16) uint8_t lanes_out[WIDTH];
+    alignas(16) uint8_t dirty[WIDTH];
+    const AlphaTables& tables = alpha_tables();
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    size_t with_errors = 0;
+
+    for(size_t base = 0; base < count; base += WIDTH) {
+        const size_t lanes = count - base < WIDTH ? count - base : WIDTH;
+        transpose(frames + base * enc_length, lanes, WIDTH, enc_length, columns);
+        __m128i any = _mm_setzero_si128();
+
+        for(uint8_t k = 0; k < ecc_length; k++) {
+            const __m128i lo = _mm_load_si128((const __m128i*) tables.alpha[k].lo);
+            const __m128i hi = _mm_load_si128((const __m128i*) tables.alpha[k].hi);
+            __m128i acc = _mm_setzero_si128();
+            for(uint8_t j = 0; j < enc_length; j++) {
+                // acc = acc * alpha^k + r_j, for 16 frames at once
+                const __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(acc, nibble));
+                const __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(acc, 4), nibble));
+                acc = _mm_xor_si128(_mm_xor_si128(l, h), _mm_load_si128((const __m128i*) (columns + j * WIDTH)));
+            }
+            any = _mm_or_si128(any, acc);
+            _mm_store_si128((__m128i*) lanes_out, acc);
+            for(size_t l = 0; l < lanes; l++) synd[(base + l) * ecc_length + k] = lanes_out[l];
+        }
+
+        _mm_store_si128((__m128i*) dirty, any);
+        for(size_t l = 0; l < lanes; l++) with_errors += dirty[l] != 0;
+    }
+    return with_errors;
+}
+
+RS_TARGET("avx2")
+static size_t syndromes_avx2(const uint8_t* frames, size_t count, uint8_t enc_length, uint8_t ecc_length,
+                             uint8_t* synd) {
+    constexpr size_t WIDTH = 32;
+    alignas(32) uint8_t columns[255 * WIDTH];
+    alignas(32) uint8_t lanes_out[WIDTH];
+    alignas(32) uint8_t dirty[WIDTH];
+    const AlphaTables& tables = alpha_tables();
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    size_t with_errors = 0;
+
+    for(size_t base = 0; base < count; base += WIDTH) {
+        const size_t lanes = count - base < WIDTH ? count - base : WIDTH;
+        transpose(frames + base * enc_length, lanes, WIDTH, enc_length, columns);
+        __m256i any = _mm256_setzero_si256();
+
+        for(uint8_t k = 0; k < ecc_length; k++) {
+            // pshufb works per 128-bit half, so both halves get the same table
+            const __m256i lo = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*) tables.alpha[k].lo));
+            const __m256i hi = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*) tables.alpha[k].hi));
+            __m256i acc = _mm256_setzero_si256();
+            for(uint8_t j = 0; j < enc_length; j++) {
+                const __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(acc, nibble));
+                const __m256i h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(acc, 4), nibble));
+                acc = _mm256_xor_si256(_mm256_xor_si256(l, h),
+                                       _mm256_load_si256((const __m256i*) (columns + j * WIDTH)));
+            }
+            any = _mm256_or_si256(any, acc);
+            _mm256_store_si256((__m256i*) lanes_out, acc);
+            for(size_t l = 0; l < lanes; l++) synd[(base + l) * ecc_length + k] = lanes_out[l];
+        }
+
+        _mm256_store_si256((__m256i*) dirty, any);
+        for(size_t l = 0; l < lanes; l++) with_errors += dirty[l] != 0;
+    }
+    return with_errors;
+}
+#endif
+
+size_t syndromes(const uint8_t* frames, size_t count, uint8_t enc_length, uint8_t ecc_length, uint8_t* synd,
+                 Isa isa) {
+    assert(ecc_length < 255);
+#ifdef RS_SIMD_X86
+    switch(clamp_isa(isa)) {
+        case ISA_AVX2:  return syndromes_avx2(frames, count, enc_length, ecc_length, synd);
+        case ISA_SSSE3: return syndromes_ssse3(frames, count, enc_length, ecc_length, synd);
+        default: break;
+    }
+#endif
+    (void) isa;
+    size_t with_errors = 0;
+    for(size_t f = 0; f < count; f++) {
+        with_errors += syndromes_scalar(frames + f * enc_length, enc_length, ecc_length, synd + f * ecc_length);
+    }
+    return with_errors;
+}
+
+#ifdef RS_SIMD_X86
+/* One frame doesn't fill more than 16 lanes, so AVX2 runs this kernel too */
+RS_TARGET("ssse3")
+static bool frame_syndromes_ssse3(const uint8_t* frame, uint8_t enc_length, uint8_t ecc_length, uint8_t* synd) {
+    const ScaleTables& scale = scale_tables();
+    const WeightTables& weight = weight_tables();
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    __m128i acc = _mm_setzero_si128();
+    for(uint8_t j = 0; j < enc_length; j++) {
+        // synd[k] ^= r_j * alpha^(k*e) for every k at once; a zero symbol scales to zero, so no branch
+        const __m128i w = _mm_load_si128((const __m128i*) weight.weights[enc_length - 1 - j]);
+        const NibbleTable& t = scale.by[frame[j]];
+        const __m128i l = _mm_shuffle_epi8(_mm_load_si128((const __m128i*) t.lo), _mm_and_si128(w, nibble));
+        const __m128i h = _mm_shuffle_epi8(_mm_load_si128((const __m128i*) t.hi),
+                                           _mm_and_si128(_mm_srli_epi64(w, 4), nibble));
+        acc = _mm_xor_si128(acc, _mm_xor_si128(l, h));
+    }
+
+    alignas(16) uint8_t out[16];
+    _mm_store_si128((__m128i*) out, acc);
+    memcpy(synd, out, ecc_length);
+    uint8_t any = 0;
+    for(uint8_t k = 0; k < ecc_length; k++) any |= out[k];
+    return any != 0;
+}
+#endif
+
+bool frame_syndromes(const uint8_t* frame, uint8_t enc_length, uint8_t ecc_length, uint8_t* synd, Isa isa) {
+    assert(ecc_length < 255);
+#ifdef RS_SIMD_X86
+    if(clamp_isa(isa) >= ISA_SSSE3 && ecc_length <= 16) {
+        return frame_syndromes_ssse3(frame, enc_length, ecc_length, synd);
+    }
+#endif
+    (void) isa;
+    return syndromes_scalar(frame, enc_length, ecc_length, synd);
+}
+
+/* ################
+ * # CHIEN SEARCH #
+ * ################ */
+
+static size_t chien_scalar(const uint8_t* loc, uint8_t loc_length, uint8_t n, uint8_t* roots) {
+    size_t found = 0;
+    for(uint16_t i = 0; i < n; i++) {
+        uint8_t y = 0;
+        for(uint8_t m = 0; m < loc_length; m++) {
+            const uint8_t c = loc[m];
+            if(c == 0) continue;
+            const uint8_t d = loc_length - 1 - m;
+            y ^= gf::exp[gf::log[c] + (i * d) % 255];
+        }
+        if(y == 0) roots[found++] = (uint8_t) i;
+    }
+    return found;
+}
+
+#ifdef RS_SIMD_X86
+RS_TARGET("ssse3")
+static size_t chien_ssse3(const uint8_t* loc, uint8_t loc_length, uint8_t n, uint8_t* roots) {
+    const PowerTables& pw = power_tables();
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i zero = _mm_setzero_si128();
+
+    NibbleTable coef[MAX_LOC_LENGTH];
+    for(uint8_t m = 0; m < loc_length; m++) make_nibble_table(loc[m], &coef[m]);
+
+    size_t found = 0;
+    for(uint16_t base = 0; base < n; base += 16) {
+        // lanes are positions i; each coefficient multiplies a row of precomputed powers
+        __m128i y = _mm_setzero_si128();
+        for(uint8_t m = 0; m < loc_length; m++) {
+            const uint8_t d = loc_length - 1 - m;
+            const __m128i v = _mm_load_si128((const __m128i*) (pw.powers[d] + base));
+            const __m128i lo = _mm_load_si128((const __m128i*) coef[m].lo);
+            const __m128i hi = _mm_load_si128((const __m128i*) coef[m].hi);
+            const __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(v, nibble));
+            const __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(v, 4), nibble));
+            y = _mm_xor_si128(y, _mm_xor_si128(l, h));
+        }
+        unsigned mask = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(y, zero));
+        while(mask) {
+            const unsigned i = base + __builtin_ctz(mask);
+            if(i >= n) break;
+            roots[found++] = (uint8_t) i;
+            mask &= mask - 1;
+        }
+    }
+    return found;
+}
+
+RS_TARGET("avx2")
+static size_t chien_avx2(const uint8_t* loc, uint8_t loc_length, uint8_t n, uint8_t* roots) {
+    const PowerTables& pw = power_tables();
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+
+    NibbleTable coef[MAX_LOC_LENGTH];
+    for(uint8_t m = 0; m < loc_length; m++) make_nibble_table(loc[m], &coef[m]);
+
+    size_t found = 0;
+    for(uint16_t base = 0; base < n; base += 32) {
+        __m256i y = _mm256_setzero_si256();
+        for(uint8_t m = 0; m < loc_length; m++) {
+            const uint8_t d = loc_length - 1 - m;
+            const __m256i v = _mm256_load_si256((const __m256i*) (pw.powers[d] + base));
+            const __m256i lo = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*) coef[m].lo));
+            const __m256i hi = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*) coef[m].hi));
+            const __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(v, nibble));
+            const __m256i h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(v, 4), nibble));
+            y = _mm256_xor_si256(y, _mm256_xor_si256(l, h));
+        }
+        unsigned mask = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(y, zero));
+        while(mask) {
+            const unsigned i = base + __builtin_ctz(mask);
+            if(i >= n) break;
+            roots[found++] = (uint8_t) i;
+            mask &= mask - 1;
+        }
+    }
+    return found;
+}
+#endif
+
+size_t chien_search(const uint8_t* loc, uint8_t loc_length, uint8_t n, uint8_t* roots, Isa isa) {
+    assert(loc_length <= MAX_LOC_LENGTH);
+#ifdef RS_SIMD_X86
+    switch(clamp_isa(isa)) {
+        case ISA_AVX2:  return chien_avx2(loc, loc_length, n, roots);
+        case ISA_SSSE3: return chien_ssse3(loc, loc_length, n, roots);
+        default: break;
+    }
+#endif
+    (void) isa;
+    return chien_scalar(loc, loc_length, n, roots);
+}
+
+} /* end of simd namespace */
+
+}
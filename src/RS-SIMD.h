@@ -0,0 +1,96 @@
+/* date = October 17, 2026 9:10 AM */
+
+/**
+ * @file RS-SIMD.h
+ * @brief Vectorized GF(256) kernels for RS-FEC.h
+ *
+ * Multiplication by a constant is done with two 16-entry nibble tables and
+ * pshufb, so one instruction multiplies 16 (SSSE3) or 32 (AVX2) symbols.
+ * The instruction set is picked at runtime; every kernel has a scalar
+ * fallback with identical results.
+ */
+
+#ifndef RS_SIMD_H
+#define RS_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace RS {
+
+namespace simd {
+
+enum Isa {
+    ISA_SCALAR = 0,
+    ISA_SSSE3,
+    ISA_AVX2,
+};
+
+/* @brief Best instruction set supported by the running CPU (detected once) */
+Isa best_isa();
+
+/* @brief Printable name of an instruction set */
+const char* isa_name(Isa isa);
+
+/* @brief Generator products for table-driven encoding
+ * rows[c][j] = c * g[j+1] where g is the monic generator polynomial (highest
+ * degree first). Bytes past ecc_length are zero. */
+struct EncodeTable {
+    uint8_t ecc_length;
+    uint8_t rows[256][16];
+};
+
+/* @brief Builds the encode table for a generator polynomial
+ * @param *generator  - ecc_length+1 coefficients, highest degree first, generator[0] == 1
+ * @param ecc_length  - length of correction code (16 at most)
+ * @param *table      - output table */
+void build_encode_table(const uint8_t* generator, uint8_t ecc_length, EncodeTable* table);
+
+/* @brief Computes the correction code of one message as an LFSR
+ * @param &table      - table from build_encode_table
+ * @param *msg        - message                        (msg_length size)
+ * @param msg_length  - message length
+ * @param *ecc        - output correction code         (table.ecc_length size)
+ * @param isa         - instruction set to use */
+void encode(const EncodeTable& table, const uint8_t* msg, size_t msg_length, uint8_t* ecc, Isa isa = best_isa());
+
+/* @brief Syndromes of many encoded frames stored back to back
+ * Frames are processed 16/32 at a time, one frame per vector lane.
+ * @param *frames     - count frames of enc_length bytes each
+ * @param count       - number of frames
+ * @param enc_length  - encoded frame length (message + ecc)
+ * @param ecc_length  - length of correction code
+ * @param *synd       - output, ecc_length syndromes per frame (count * ecc_length size)
+ * @param isa         - instruction set to use
+ * @return number of frames with at least one non-zero syndrome */
+size_t syndromes(const uint8_t* frames, size_t count, uint8_t enc_length, uint8_t ecc_length, uint8_t* synd,
+                 Isa isa = best_isa());
+
+/* @brief Syndromes of a single encoded frame
+ * One vector lane per syndrome, so the whole frame is one pass over its bytes
+ * without transposing. Codes with more than 16 ecc symbols use the scalar loop.
+ * @param *frame      - encoded frame              (enc_length size)
+ * @param enc_length  - encoded frame length (message + ecc)
+ * @param ecc_length  - length of correction code
+ * @param *synd       - output syndromes           (ecc_length size)
+ * @param isa         - instruction set to use
+ * @return true if at least one syndrome is non-zero */
+bool frame_syndromes(const uint8_t* frame, uint8_t enc_length, uint8_t ecc_length, uint8_t* synd,
+                     Isa isa = best_isa());
+
+/* @brief Chien search
+ * Evaluates the locator at alpha^i for every i in [0, n) and reports the
+ * i where it is zero, in ascending order.
+ * @param *loc        - locator polynomial, highest degree first (33 coefficients at most)
+ * @param loc_length  - number of coefficients
+ * @param n           - number of positions to test (encoded frame length)
+ * @param *roots      - output positions (n size at least)
+ * @param isa         - instruction set to use
+ * @return number of roots found */
+size_t chien_search(const uint8_t* loc, uint8_t loc_length, uint8_t n, uint8_t* roots, Isa isa = best_isa());
+
+} /* end of simd namespace */
+
+}
+
+#endif // RS_SIMD_H
@@ -0,0 +1,183 @@
+/* date = October 17, 2026 9:55 PM */
+
+
+#include "ReplayReader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "Capture.h"
+
+namespace DS {
+    // start bit, 8 data bits, stop bit
+    static constexpr double BITS_PER_BYTE = 10.0;
+
+    ReplayReader::ReplayReader(const std::filesystem::path &path, const double speed, const int baud)
+        : speed(speed), bytes_per_second(std::max(baud, 1) / BITS_PER_BYTE) {
+        if (path.extension() == ".dslog") {
+            session = SessionReader::open(path);
+            if (!session) {
+                printf("Replay error: couldn't open session log %s\n", path.string().c_str());
+                exit(2);
+            }
+        } else {
+            raw = MappedFile::open(path);
+            if (!raw) {
+                printf("Replay error: couldn't open capture %s\n", path.string().c_str());
+                exit(2);
+            }
+            if (path.extension() == ".dscap") {
+                uint32_t version = 0;
+                if (raw->size() >= CAPTURE_HEADER_SIZE) {
+                    memcpy(&version, raw->data() + sizeof(CAPTURE_MAGIC), sizeof(version));
+                }
+                if (raw->size() < CAPTURE_HEADER_SIZE || memcmp(raw->data(), CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0
+                    || version != CAPTURE_VERSION) {
+                    printf("Replay error: %s is not a version %u capture\n", path.string().c_str(), CAPTURE_VERSION);
+                    exit(2);
+                }
+                chunked = true;
+                position = CAPTURE_HEADER_SIZE;
+            }
+        }
+
+        if (speed > 0) {
+            printf("Replaying %s at %gx speed\n", path.string().c_str(), speed);
+        } else {
+            printf("Replaying %s as fast as possible\n", path.string().c_str());
+        }
+    }
+
+    bool ReplayReader::next_frame() {
+        while (slot < session->slot_count()) {
+            const PacketSlot *p = session->packet(slot++);
+            if (!p) continue;
+
+            // the frame the car would have sent: header, type, timestamp, then the entry bytes
+            uint8_t msg[MSG_LENGTH]{};
+            memcpy(msg, "UKSC", 4);
+            msg[MESSAGE_TYPE_BYTE] = p->type;
+            memcpy(&msg[TIME_OFFSET], &p->car_timestamp, sizeof(p->car_timestamp));
+            memcpy(&msg[DATA_OFFSET], p->data, MSG_LENGTH - DATA_OFFSET);
+            rs.Encode(msg, frame);
+
+            if (!start) {
+                first_ns = p->host_monotonic_ns;
+            }
+            piece = frame;
+            piece_len = BUFFER_LENGTH;
+            piece_pos = 0;
+            piece_ns = p->host_monotonic_ns;
+            return true;
+        }
+        return false;
+    }
+
+    bool ReplayReader::next_chunk() {
+        while (position + CAPTURE_CHUNK_HEADER_SIZE <= raw->size()) {
+            int64_t ns;
+            uint32_t length;
+            memcpy(&ns, raw->data() + position, sizeof(ns));
+            memcpy(&length, raw->data() + position + sizeof(ns), sizeof(length));
+            position += CAPTURE_CHUNK_HEADER_SIZE;
+            // a capture cut short by a crash ends in a partial chunk; play what made it to disk
+            length = static_cast<uint32_t>(std::min<size_t>(length, raw->size() - position));
+            if (length == 0) continue;
+
+            if (!start) {
+                first_ns = ns;
+            }
+            piece = raw->data() + position;
+            piece_len = length;
+            piece_pos = 0;
+            piece_ns = ns;
+            position += length;
+            return true;
+        }
+        position = raw->size();
+        return false;
+    }
+
+    ReplayReader::Clock::time_point ReplayReader::due() const {
+        const double seconds = session || chunked
+            ? static_cast<double>(piece_ns - first_ns) / 1e9 / speed
+            : static_cast<double>(position) / bytes_per_second / speed;
+        return *start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    int ReplayReader::read_bytes(std::span<uint8_t> out, const unsigned int timeout_ms) {
+        const auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms);
+        size_t count = 0;
+        while (count < out.size()) {
+            if (session) {
+                if (piece_pos == piece_len && !next_frame()) break;
+            } else if (chunked) {
+                if (piece_pos == piece_len && !next_chunk()) break;
+            } else if (position >= raw->size()) {
+                break;
+            }
+            if (!start) {
+                start = Clock::now();
+            }
+
+            if (speed > 0) {
+                const auto when = due();
+                if (when > Clock::now()) {
+                    // hand out what is ready now rather than holding it back for later bytes
+                    if (count > 0) break;
+                    if (when > deadline) {
+                        std::this_thread::sleep_until(deadline);
+                        return 0;
+                    }
+                    std::this_thread::sleep_until(when);
+                }
+            }
+
+            if (session || chunked) {
+                const size_t n = std::min(piece_len - piece_pos, out.size() - count);
+                memcpy(out.data() + count, piece + piece_pos, n);
+                piece_pos += n;
+                count += n;
+            } else {
+                size_t n = std::min(raw->size() - position, out.size() - count);
+                if (speed > 0) {
+                    // everything whose time has come, and at least the byte just waited for
+                    const double elapsed = std::chrono::duration<double>(Clock::now() - *start).count();
+                    const auto ready = static_cast<size_t>(elapsed * bytes_per_second * speed);
+                    n = std::min(n, std::max<size_t>(ready > position ? ready - position : 0, 1));
+                }
+                memcpy(out.data() + count, raw->data() + position, n);
+                position += n;
+                count += n;
+            }
+        }
+        return static_cast<int>(count);
+    }
+
+    uint8_t ReplayReader::get_byte() {
+        uint8_t b = 0;
+        read_bytes({&b, 1}, READ_TIMEOUT_MS);
+        return b;
+    }
+
+    bool ReplayReader::at_end() const {
+        if (piece_pos < piece_len) return false;
+        if (chunked) {
+            // only empty chunks would be left; next_chunk skips those
+            for (size_t at = position; at + CAPTURE_CHUNK_HEADER_SIZE <= raw->size();) {
+                uint32_t length;
+                memcpy(&length, raw->data() + at + sizeof(int64_t), sizeof(length));
+                at += CAPTURE_CHUNK_HEADER_SIZE;
+                if (length > 0 && at < raw->size()) return false;
+                at += length;
+            }
+            return true;
+        }
+        if (raw) return position >= raw->size();
+        for (size_t i = slot; i < session->slot_count(); i++) {
+            if (session->packet(i)) return false;
+        }
+        return true;
+    }
+} // DS
@@ -0,0 +1,106 @@
+/* date = October 17, 2026 9:55 PM */
+
+
+#ifndef REPLAYREADER_H
+#define REPLAYREADER_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+#include "IOSerial.h"
+#include "MappedFile.h"
+#include "RS-FEC.h"
+#include "SessionLog.h"
+#include "common.h"
+
+namespace DS {
+
+/**
+ * Plays a recording back in place of the serial port, so it goes through BufferParser and the rest of the pipeline
+ * exactly like live data.
+ *
+ * Three kinds of recordings are understood:
+ * - Session logs (`*.dslog`). Every packet is re-encoded into a frame, and frames are spaced by the receive times
+ *   they were logged with.
+ * - Captures (`*.dscap`, see Capture). The serial bytes are sent as they were read, spaced by their receive times.
+ * - Anything else is taken as raw serial bytes, and paced at the byte rate of `baud`.
+ *
+ * `speed` scales time: 1 is real time, 10 is ten times faster, and 0 sends everything as fast as it is read.
+ */
+class ReplayReader : public IOSerial {
+public:
+    /**
+     * Errors are fatal, like failing to open a serial port.
+     * @param path Recording to play.
+     * @param speed Playback speed, or 0 for as fast as possible.
+     * @param baud Line rate used to pace raw byte recordings.
+     */
+    ReplayReader(const std::filesystem::path &path, double speed, int baud);
+    ~ReplayReader() override = default;
+
+    int available() override {
+        return at_end() ? 0 : 1;
+    }
+
+    uint8_t get_byte() override;
+
+    int read_bytes(std::span<uint8_t> out, unsigned int timeout_ms) override;
+
+    [[nodiscard]] bool at_end() const override;
+
+    // there is no radio to talk to, so anything sent is dropped
+    bool put(const std::string &s) override {
+        (void) s;
+        return true;
+    }
+
+    bool put_byte(char c) override {
+        (void) c;
+        return true;
+    }
+
+    bool put_bytes(const char *buf, int len) override {
+        (void) buf;
+        (void) len;
+        return true;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // encodes the next session packet into `frame`; false once there are none left
+    bool next_frame();
+    // points `piece` at the next chunk of the capture; false once there are none left
+    bool next_chunk();
+    // when the byte `position` (raw) or the current piece (session, capture) is due
+    [[nodiscard]] Clock::time_point due() const;
+
+    double speed;
+    std::optional<Clock::time_point> start;
+
+    // the bytes sent together at `piece_ns`: a frame for sessions, a chunk for captures
+    const uint8_t *piece = nullptr;
+    size_t piece_len = 0;
+    // bytes of the piece already handed out; a finished piece means a new one is needed
+    size_t piece_pos = 0;
+    int64_t piece_ns = 0;
+    int64_t first_ns = 0;
+
+    // session playback
+    std::optional<SessionReader> session;
+    size_t slot = 0;
+    uint8_t frame[BUFFER_LENGTH]{};
+    RS::ReedSolomon<MSG_LENGTH, ECC_LENGTH> rs{};
+
+    // capture and raw playback; `position` is the next chunk header of a capture, or the next byte of raw data
+    std::optional<MappedFile> raw;
+    bool chunked = false;
+    size_t position = 0;
+    double bytes_per_second;
+};
+
+} // DS
+
+#endif //REPLAYREADER_H
@@ -0,0 +1,92 @@
+/* date = October 17, 2026 5:30 PM */
+
+
+#ifndef RINGSERIES_H
+#define RINGSERIES_H
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace DS {
+    /**
+     * Fixed-capacity history of (x, y) points, kept as two parallel columns.
+     *
+     * Once full, every new point replaces the oldest one. Each column is stored twice back to back ("mirrored"), so
+     * the live points are always one contiguous run that can be handed to ImPlot without copying.
+     *
+     * x values are expected to be pushed in non-decreasing order, which `lower_bound` relies on.
+     */
+    class RingSeries {
+    public:
+        explicit RingSeries(const size_t capacity)
+            : cap(std::max<size_t>(capacity, 1)), x(2 * cap), y(2 * cap) {
+        }
+
+        void push(const double xv, const double yv) {
+            size_t pos;
+            if (count < cap) {
+                pos = head + count;
+                if (pos >= cap) pos -= cap;
+                count++;
+            } else {
+                // full: overwrite the oldest point
+                pos = head;
+                head = head + 1 == cap ? 0 : head + 1;
+            }
+            x[pos] = x[pos + cap] = xv;
+            y[pos] = y[pos + cap] = yv;
+        }
+
+        void clear() {
+            head = 0;
+            count = 0;
+        }
+
+        [[nodiscard]] size_t size() const {
+            return count;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return count == 0;
+        }
+
+        [[nodiscard]] size_t capacity() const {
+            return cap;
+        }
+
+        /**
+         * @return x values, oldest first.
+         */
+        [[nodiscard]] std::span<const double> xs() const {
+            return {x.data() + head, count};
+        }
+
+        /**
+         * @return y values, oldest first.
+         */
+        [[nodiscard]] std::span<const double> ys() const {
+            return {y.data() + head, count};
+        }
+
+        /**
+         * @param xv x value to search for.
+         * @return Index (into `xs()`/`ys()`) of the first point with x >= `xv`, found by binary search.
+         */
+        [[nodiscard]] size_t lower_bound(const double xv) const {
+            const auto s = xs();
+            return std::lower_bound(s.begin(), s.end(), xv) - s.begin();
+        }
+
+    private:
+        size_t cap;
+        // index of the oldest point in the first copy
+        size_t head = 0;
+        size_t count = 0;
+        std::vector<double> x;
+        std::vector<double> y;
+    };
+} // DS
+
+#endif //RINGSERIES_H
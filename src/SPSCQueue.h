@@ -0,0 +1,102 @@
+/* date = October 17, 2026 11:20 AM */
+
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace DS {
+    // Most desktop CPUs use 64 byte cache lines. Indices written by different threads live on different lines so
+    // the producer and consumer don't keep stealing each other's cache line.
+    constexpr size_t CACHE_LINE_SIZE = 64;
+
+    /**
+     * Bounded, lock-free queue for exactly one producer thread and one consumer thread.
+     *
+     * The producer calls `push`, the consumer calls `drain`. Neither ever blocks: a push into a full queue is dropped
+     * and counted in `overflows()`.
+     * @tparam T Element type. Copied in and handed out by reference.
+     * @tparam Capacity Number of slots. Must be a power of two.
+     */
+    template<typename T, size_t Capacity>
+    class SPSCQueue {
+        static_assert(Capacity && (Capacity & (Capacity - 1)) == 0, "SPSCQueue capacity must be a power of two");
+
+    public:
+        SPSCQueue() : slots(std::make_unique<T[]>(Capacity)) {}
+
+        SPSCQueue(const SPSCQueue &) = delete;
+        SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+        /**
+         * Producer side. Copies `value` into the queue.
+         * @return false (and counts an overflow) if the queue was full.
+         */
+        bool push(const T &value) {
+            const size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head_cache == Capacity) {
+                // looks full; refresh our view of the consumer before giving up
+                head_cache = head.load(std::memory_order_acquire);
+                if (t - head_cache == Capacity) {
+                    overflow_count.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+            }
+            slots[t & MASK] = value;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Consumer side. Calls `fn` on every element that was in the queue when this was called, then releases all
+         * of their slots at once.
+         * @param fn Callable taking `const T &`.
+         * @return Number of elements consumed.
+         */
+        template<typename F>
+        size_t drain(F &&fn) {
+            const size_t h = head.load(std::memory_order_relaxed);
+            const size_t t = tail.load(std::memory_order_acquire);
+            for (size_t i = h; i != t; i++) {
+                fn(static_cast<const T &>(slots[i & MASK]));
+            }
+            head.store(t, std::memory_order_release);
+            return t - h;
+        }
+
+        /**
+         * @return Number of elements dropped because the queue was full. Safe to call from any thread.
+         */
+        [[nodiscard]] uint64_t overflows() const {
+            return overflow_count.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return Number of queued elements. Only a snapshot when called while the other thread is running.
+         */
+        [[nodiscard]] size_t size() const {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+    private:
+        static constexpr size_t MASK = Capacity - 1;
+
+        // written by the producer only
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail{0};
+        // producer's last known value of `head`
+        size_t head_cache{0};
+
+        // written by the consumer only
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> head{0};
+
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> overflow_count{0};
+
+        std::unique_ptr<T[]> slots;
+    };
+} // DS
+
+#endif //SPSCQUEUE_H
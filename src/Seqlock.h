@@ -0,0 +1,108 @@
+/* date = October 17, 2026 1:05 PM */
+
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <thread>
+
+namespace DS {
+    /**
+     * Fixed-size byte buffer with one writer and any number of readers, published through a sequence lock.
+     *
+     * The writer never waits. Readers never block the writer: they copy the bytes they want and retry if a publish
+     * happened in the meantime, so every read returns bytes from a single publish. The payload is kept in relaxed
+     * atomic words so a read racing a publish is well-defined (and then discarded).
+     */
+    class SeqlockBuffer {
+    public:
+        explicit SeqlockBuffer(const size_t size)
+            : bytes(size), words(std::make_unique<std::atomic<uint64_t>[]>((size + WORD - 1) / WORD)) {
+        }
+
+        SeqlockBuffer(const SeqlockBuffer &) = delete;
+        SeqlockBuffer &operator=(const SeqlockBuffer &) = delete;
+
+        /**
+         * Replace the contents of the buffer. Bytes past the end of `src` are zeroed.
+         * NOTE: only one thread may publish to a given buffer.
+         * @param src New contents. Anything past `size()` is ignored.
+         */
+        void publish(const std::span<const uint8_t> src) {
+            const uint64_t s = seq.load(std::memory_order_relaxed);
+            seq.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            const size_t n = std::min(src.size(), bytes);
+            for (size_t w = 0; w * WORD < bytes; w++) {
+                uint64_t v = 0;
+                if (w * WORD < n) {
+                    memcpy(&v, src.data() + w * WORD, std::min(WORD, n - w * WORD));
+                }
+                words[w].store(v, std::memory_order_relaxed);
+            }
+
+            seq.store(s + 2, std::memory_order_release);
+        }
+
+        /**
+         * Copy `dst.size()` bytes starting at `offset` out of the buffer, all from the same publish.
+         * @param offset Byte offset into the buffer.
+         * @param dst Where to copy to. `offset + dst.size()` must not exceed `size()`.
+         * @return Generation of the copied data, i.e. the number of publishes before it.
+         */
+        uint64_t read(const size_t offset, const std::span<uint8_t> dst) const {
+            assert(offset + dst.size() <= bytes);
+            const size_t end = offset + dst.size();
+
+            for (;;) {
+                const uint64_t s = seq.load(std::memory_order_acquire);
+                if (s & 1) {
+                    // writer is mid-publish; it only ever holds it for a few stores
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                for (size_t w = offset / WORD; w * WORD < end; w++) {
+                    const uint64_t v = words[w].load(std::memory_order_relaxed);
+                    const size_t lo = std::max(offset, w * WORD);
+                    const size_t hi = std::min(end, (w + 1) * WORD);
+                    memcpy(dst.data() + (lo - offset), reinterpret_cast<const uint8_t *>(&v) + (lo - w * WORD), hi - lo);
+                }
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq.load(std::memory_order_relaxed) == s) {
+                    return s / 2;
+                }
+            }
+        }
+
+        /**
+         * @return Number of completed publishes. Changes whenever the contents do.
+         */
+        [[nodiscard]] uint64_t generation() const {
+            return seq.load(std::memory_order_acquire) / 2;
+        }
+
+        [[nodiscard]] size_t size() const {
+            return bytes;
+        }
+
+    private:
+        static constexpr size_t WORD = sizeof(uint64_t);
+
+        // odd while a publish is in progress
+        std::atomic<uint64_t> seq{0};
+        size_t bytes;
+        std::unique_ptr<std::atomic<uint64_t>[]> words;
+    };
+} // DS
+
+#endif //SEQLOCK_H
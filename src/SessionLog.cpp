@@ -0,0 +1,247 @@
+/* date = October 17, 2026 8:25 PM */
+
+
+#include "SessionLog.h"
+
+#include <iostream>
+
+namespace DS {
+    static constexpr char SESSION_MAGIC[8] = {'D', 'S', 'L', 'O', 'G', 0, 0, 0};
+    static constexpr uint32_t SESSION_VERSION = 1;
+    // magic, version, header size, entry count
+    static constexpr size_t SESSION_PREAMBLE_SIZE = sizeof(SESSION_MAGIC) + 3 * sizeof(uint32_t);
+
+    template<typename T>
+    static void put(std::vector<uint8_t> &out, const T v) {
+        const auto *p = reinterpret_cast<const uint8_t *>(&v);
+        out.insert(out.end(), p, p + sizeof(v));
+    }
+
+    static void put_string(std::vector<uint8_t> &out, const std::string &str) {
+        put(out, static_cast<uint16_t>(str.size()));
+        out.insert(out.end(), str.begin(), str.end());
+    }
+
+    std::vector<uint8_t> SessionWriter::encode_header(const Config &config) {
+        std::vector<uint8_t> out(SESSION_MAGIC, SESSION_MAGIC + sizeof(SESSION_MAGIC));
+        put(out, SESSION_VERSION);
+        // header size, filled in below
+        put(out, uint32_t{0});
+        put(out, static_cast<uint32_t>(config.get_entries().size()));
+
+        for (const auto &[name, entry]: config.get_entries()) {
+            const auto id = static_cast<uint32_t>(config.get_id_of(name).value_or(0));
+            put_string(out, name);
+            put(out, id);
+            put(out, static_cast<uint32_t>(entry.get_size()));
+            put(out, static_cast<uint32_t>(entry.get_fields().size()));
+            for (const auto &[field_name, field]: entry.get_fields()) {
+                put_string(out, field_name);
+                put(out, static_cast<uint32_t>(field.offset));
+                put(out, static_cast<uint8_t>(field.ty));
+            }
+        }
+
+        // slots start on a slot boundary
+        out.resize((out.size() + SESSION_SLOT_SIZE - 1) / SESSION_SLOT_SIZE * SESSION_SLOT_SIZE);
+        const auto size = static_cast<uint32_t>(out.size());
+        memcpy(out.data() + sizeof(SESSION_MAGIC) + sizeof(uint32_t), &size, sizeof(size));
+        return out;
+    }
+
+    SessionWriter::~SessionWriter() {
+        close();
+    }
+
+    bool SessionWriter::open(const std::filesystem::path &path, const std::span<const uint8_t> header) {
+        close();
+        file = fopen(path.string().c_str(), "wb");
+        if (!file) {
+            std::cerr << "SessionWriter: could not open " << path << "\n";
+            return false;
+        }
+        setvbuf(file, nullptr, _IONBF, 0);
+        buffer.resize(LOG_BUFFER_BYTES);
+        used = 0;
+        slots = 0;
+        index = {};
+        index.prev_index = IndexSlot::NO_SLOT;
+
+        if (fwrite(header.data(), 1, header.size(), file) != header.size()) {
+            std::cerr << "SessionWriter: write to " << path << " failed\n";
+        }
+        return true;
+    }
+
+    void SessionWriter::append(const PacketSlot &slot) {
+        if (!file) return;
+        if (index.packets == 0) {
+            index.first_ns = slot.host_monotonic_ns;
+            index.first_slot = slots;
+        }
+        index.last_ns = slot.host_monotonic_ns;
+        index.packets++;
+
+        put_slot(&slot);
+        if (index.packets == SESSION_INDEX_INTERVAL) {
+            put_index();
+        }
+    }
+
+    void SessionWriter::put_slot(const void *slot) {
+        if (buffer.size() - used < SESSION_SLOT_SIZE) {
+            flush();
+        }
+        memcpy(buffer.data() + used, slot, SESSION_SLOT_SIZE);
+        used += SESSION_SLOT_SIZE;
+        slots++;
+    }
+
+    void SessionWriter::put_index() {
+        IndexSlot slot = index;
+        slot.tag = SLOT_INDEX;
+        const uint64_t at = slots;
+        put_slot(&slot);
+
+        index = {};
+        index.prev_index = at;
+    }
+
+    void SessionWriter::flush() {
+        if (!file || !used) return;
+        if (fwrite(buffer.data(), 1, used, file) != used) {
+            std::cerr << "SessionWriter: write failed\n";
+        }
+        used = 0;
+    }
+
+    void SessionWriter::close() {
+        if (!file) return;
+        if (index.packets) {
+            put_index();
+        }
+        flush();
+        fclose(file);
+        file = nullptr;
+    }
+
+    std::optional<SessionReader> SessionReader::open(const std::filesystem::path &path) {
+        auto file = MappedFile::open(path);
+        if (!file) return std::nullopt;
+        SessionReader reader{std::move(*file)};
+        if (!reader.parse_header()) {
+            std::cerr << "SessionReader: " << path << " is not a valid session log\n";
+            return std::nullopt;
+        }
+        reader.load_index();
+        return reader;
+    }
+
+    const SessionReader::Entry *SessionReader::get_entry(const std::string &name) const {
+        for (const Entry &e: entries) {
+            if (e.name == name) return &e;
+        }
+        return nullptr;
+    }
+
+    bool SessionReader::parse_header() {
+        const uint8_t *base = file.data();
+        const size_t length = file.size();
+        size_t pos = 0;
+        // every read is bounds checked, so a truncated or foreign file fails here instead of later. once the header
+        // size is known, reads are limited to the header
+        size_t limit = length;
+        auto get = [base, &limit, &pos]<typename T>(T &v) {
+            if (pos + sizeof(T) > limit) return false;
+            memcpy(&v, base + pos, sizeof(T));
+            pos += sizeof(T);
+            return true;
+        };
+        auto get_string = [base, &limit, &pos, &get](std::string &str) {
+            uint16_t n;
+            if (!get(n) || pos + n > limit) return false;
+            str.assign(reinterpret_cast<const char *>(base + pos), n);
+            pos += n;
+            return true;
+        };
+
+        if (length < SESSION_PREAMBLE_SIZE || memcmp(base, SESSION_MAGIC, sizeof(SESSION_MAGIC)) != 0) {
+            return false;
+        }
+        pos = sizeof(SESSION_MAGIC);
+        uint32_t version, header_size, count;
+        if (!get(version) || !get(header_size) || !get(count)) return false;
+        if (version != SESSION_VERSION) {
+            std::cerr << "SessionReader: unsupported version " << version << "\n";
+            return false;
+        }
+        if (header_size > length || header_size % SESSION_SLOT_SIZE != 0) return false;
+        limit = header_size;
+
+        entries.clear();
+        for (uint32_t i = 0; i < count; i++) {
+            Entry e;
+            uint32_t fields;
+            if (!get_string(e.name) || !get(e.id) || !get(e.size) || !get(fields)) return false;
+            if (e.size > MSG_LENGTH) return false;
+            for (uint32_t j = 0; j < fields; j++) {
+                Field f;
+                uint8_t ty;
+                if (!get_string(f.name) || !get(f.offset) || !get(ty)) return false;
+                if (ty > Config::F64) return false;
+                f.ty = static_cast<Config::FieldType>(ty);
+                // fields are read straight out of packet slots, so they have to lie inside the buffer
+                uint8_t raw[sizeof(uint64_t)]{};
+                const size_t size = Config::visit_field(f.ty, raw, [](auto v) { return sizeof(v); });
+                if (f.offset + size > e.size) return false;
+                e.fields.push_back(std::move(f));
+            }
+            entries.push_back(std::move(e));
+        }
+        if (pos > header_size) return false;
+
+        slot_base = base + header_size;
+        slots = (length - header_size) / SESSION_SLOT_SIZE;
+        return true;
+    }
+
+    void SessionReader::load_index() {
+        index.clear();
+        // the last index slot is at most one interval from the end, unless the writer was cut off
+        uint64_t at = IndexSlot::NO_SLOT;
+        for (size_t i = slots; i > 0 && slots - i <= SESSION_INDEX_INTERVAL; i--) {
+            if (slot_base[(i - 1) * SESSION_SLOT_SIZE] == SLOT_INDEX) {
+                at = i - 1;
+                break;
+            }
+        }
+        while (at != IndexSlot::NO_SLOT && at < slots) {
+            IndexSlot slot;
+            memcpy(&slot, slot_base + at * SESSION_SLOT_SIZE, sizeof(slot));
+            if (slot.tag != SLOT_INDEX || (slot.prev_index >= at && slot.prev_index != IndexSlot::NO_SLOT)) break;
+            index.push_back(slot);
+            at = slot.prev_index;
+        }
+        std::reverse(index.begin(), index.end());
+    }
+
+    SessionReader::SlotRange SessionReader::between(const int64_t from_ns, const int64_t to_ns) const {
+        SlotRange range = all();
+        if (index.empty()) return range;
+
+        // first group that may reach `from_ns`
+        const auto first = std::partition_point(index.begin(), index.end(), [from_ns](const IndexSlot &s) {
+            return s.last_ns < from_ns;
+        });
+        // first group that starts after `to_ns`
+        const auto last = std::partition_point(first, index.end(), [to_ns](const IndexSlot &s) {
+            return s.first_ns <= to_ns;
+        });
+
+        if (first != index.end()) range.first = first->first_slot;
+        else range.first = index.back().first_slot + index.back().packets;
+        // packets after the last index slot aren't covered by it, so they stay in
+        if (last != index.end()) range.last = last->first_slot;
+        return range;
+    }
+} // DS
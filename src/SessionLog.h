@@ -0,0 +1,356 @@
+/* date = October 17, 2026 8:25 PM */
+
+
+#ifndef SESSIONLOG_H
+#define SESSIONLOG_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Config.h"
+#include "MappedFile.h"
+#include "common.h"
+
+/*
+ * Binary session log ("*.dslog").
+ *
+ * Layout, all integers in host (little-endian) byte order:
+ *
+ *   header   "DSLOG" magic, version, total header size, then the schema: every buffer of the Config with its message
+ *            id, size, and fields (name, offset, FieldType). Padded to a whole number of slots.
+ *   slots    fixed-size 64-byte records, appended as packets arrive. Most are `PacketSlot`s holding the raw entry
+ *            bytes of one packet with its car and host timestamps. Every `SESSION_INDEX_INTERVAL` packets (and when
+ *            the file is closed) an `IndexSlot` is written that summarizes the packets since the previous one.
+ *
+ * Because every slot has the same size, a reader can map the file and walk any buffer's packets in place, and a
+ * file cut short by a crash is still readable up to its last whole slot.
+ */
+namespace DS {
+    // packets per index slot
+    constexpr uint32_t SESSION_INDEX_INTERVAL = 4096;
+    constexpr size_t SESSION_SLOT_SIZE = 64;
+
+    enum SessionSlotTag : uint8_t {
+        SLOT_PACKET = 'P',
+        SLOT_INDEX = 'I',
+    };
+
+    struct PacketSlot {
+        uint8_t tag;
+        // message id the packet arrived with
+        uint8_t type;
+        uint8_t reserved[2];
+        int32_t car_timestamp;
+        int64_t host_monotonic_ns;
+        int64_t unix_time;
+        // entry bytes, as published to Config::Entry
+        uint8_t data[MSG_LENGTH];
+    };
+    static_assert(sizeof(PacketSlot) == SESSION_SLOT_SIZE);
+
+    struct IndexSlot {
+        uint8_t tag;
+        uint8_t reserved[3];
+        // packets since the previous index slot
+        uint32_t packets;
+        // host time of the first and last of those packets
+        int64_t first_ns;
+        int64_t last_ns;
+        // slot number of the first of those packets
+        uint64_t first_slot;
+        // slot number of the previous index slot, or NO_SLOT
+        uint64_t prev_index;
+        uint8_t padding[24];
+
+        static constexpr uint64_t NO_SLOT = ~0ull;
+    };
+    static_assert(sizeof(IndexSlot) == SESSION_SLOT_SIZE);
+
+    /**
+     * Appends packets to a session log. Writes are batched in memory; nothing is written until the batch fills or
+     * `flush` is called.
+     */
+    class SessionWriter {
+    public:
+        SessionWriter() = default;
+        ~SessionWriter();
+
+        SessionWriter(const SessionWriter &) = delete;
+        SessionWriter &operator=(const SessionWriter &) = delete;
+
+        /**
+         * Encodes the file header for a config. Cheap enough to call on the UI thread.
+         * @param config Config whose buffers the session will hold.
+         * @return Header bytes, a whole number of slots long.
+         */
+        static std::vector<uint8_t> encode_header(const Config &config);
+
+        /**
+         * Creates `path` and writes `header` to it. Any file already open is closed first.
+         * @return false if the file couldn't be created.
+         */
+        bool open(const std::filesystem::path &path, std::span<const uint8_t> header);
+
+        void append(const PacketSlot &slot);
+        void flush();
+
+        /**
+         * Writes the index slot for any packets since the last one, then flushes and closes the file.
+         */
+        void close();
+
+        [[nodiscard]] bool is_open() const {
+            return file != nullptr;
+        }
+
+    private:
+        void put_slot(const void *slot);
+        void put_index();
+
+        FILE *file = nullptr;
+        std::vector<uint8_t> buffer;
+        size_t used = 0;
+
+        // slots written so far, including index slots
+        uint64_t slots = 0;
+        IndexSlot index{};
+    };
+
+    /**
+     * Read-only view of a session log, mapped into memory.
+     *
+     * Nothing is copied or parsed past the header when the file is opened; columns read values straight out of the
+     * mapping as they are iterated, so the cost of loading a session is only the pages that are actually touched.
+     */
+    class SessionReader {
+    public:
+        struct Field {
+            std::string name;
+            uint32_t offset;
+            Config::FieldType ty;
+        };
+
+        struct Entry {
+            std::string name;
+            uint32_t id;
+            uint32_t size;
+            std::vector<Field> fields;
+
+            [[nodiscard]] const Field *field(const std::string &field_name) const {
+                for (const Field &f: fields) {
+                    if (f.name == field_name) return &f;
+                }
+                return nullptr;
+            }
+        };
+
+        /**
+         * A range of slots, by slot number.
+         */
+        struct SlotRange {
+            size_t first;
+            size_t last;
+        };
+
+        /**
+         * One value per packet of a single buffer, read in place from the mapping.
+         *
+         * Iterating skips the slots of other buffers and index slots; each step reads the tag and type of the next
+         * slot only.
+         */
+        template<typename T>
+        class Column {
+        public:
+            class iterator {
+            public:
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+
+                iterator() = default;
+
+                T operator*() const {
+                    T v;
+                    memcpy(&v, slot + offset, sizeof(v));
+                    return v;
+                }
+
+                /**
+                 * @return The whole packet this value came from.
+                 */
+                [[nodiscard]] const PacketSlot &packet() const {
+                    return *reinterpret_cast<const PacketSlot *>(slot);
+                }
+
+                iterator &operator++() {
+                    slot += SESSION_SLOT_SIZE;
+                    skip();
+                    return *this;
+                }
+
+                iterator operator++(int) {
+                    iterator prev = *this;
+                    ++*this;
+                    return prev;
+                }
+
+                bool operator==(const iterator &other) const {
+                    return slot == other.slot;
+                }
+
+            private:
+                friend class Column;
+
+                iterator(const uint8_t *slot, const uint8_t *end, const uint8_t type, const size_t offset)
+                    : slot(slot), end(end), type(type), offset(offset) {
+                    skip();
+                }
+
+                void skip() {
+                    while (slot != end && (slot[0] != SLOT_PACKET || slot[1] != type)) {
+                        slot += SESSION_SLOT_SIZE;
+                    }
+                }
+
+                const uint8_t *slot = nullptr;
+                const uint8_t *end = nullptr;
+                uint8_t type = 0;
+                size_t offset = 0;
+            };
+
+            [[nodiscard]] iterator begin() const {
+                return {first, last, type, offset};
+            }
+
+            [[nodiscard]] iterator end() const {
+                return {last, last, type, offset};
+            }
+
+        private:
+            friend class SessionReader;
+
+            Column(const uint8_t *first, const uint8_t *last, const uint8_t type, const size_t offset)
+                : first(first), last(last), type(type), offset(offset) {
+            }
+
+            const uint8_t *first;
+            const uint8_t *last;
+            uint8_t type;
+            // byte offset of the value within a slot
+            size_t offset;
+        };
+
+        /**
+         * Maps a session log and reads its header. Errors are printed.
+         * @param path File to open.
+         * @return The reader, or std::nullopt if the file is missing or isn't a session log.
+         */
+        static std::optional<SessionReader> open(const std::filesystem::path &path);
+
+
+        [[nodiscard]] const std::vector<Entry> &get_entries() const {
+            return entries;
+        }
+
+        [[nodiscard]] const Entry *get_entry(const std::string &name) const;
+
+        /**
+         * @return Number of whole slots in the file, packets and index slots together.
+         */
+        [[nodiscard]] size_t slot_count() const {
+            return slots;
+        }
+
+        /**
+         * @param slot Slot number, below `slot_count()`.
+         * @return The packet in that slot, or nullptr if it is an index slot.
+         */
+        [[nodiscard]] const PacketSlot *packet(const size_t slot) const {
+            const uint8_t *p = slot_base + slot * SESSION_SLOT_SIZE;
+            return p[0] == SLOT_PACKET ? reinterpret_cast<const PacketSlot *>(p) : nullptr;
+        }
+
+        [[nodiscard]] SlotRange all() const {
+            return {0, slots};
+        }
+
+        /**
+         * Uses the index slots to narrow down where packets received in `[from_ns, to_ns]` (host monotonic time)
+         * are. The range may include some packets outside the interval, but never leaves one out.
+         */
+        [[nodiscard]] SlotRange between(int64_t from_ns, int64_t to_ns) const;
+
+        /**
+         * @tparam T Type to read the field as. Must have the size of the field's type.
+         * @param ident Field name in the format of "buffer.field".
+         * @param range Slots to look at.
+         * @return The field's values, oldest first, or std::nullopt if there is no such field or `T` doesn't fit it.
+         */
+        template<typename T>
+        [[nodiscard]] std::optional<Column<T>> field(const std::string &ident, const SlotRange range) const {
+            const size_t dot = ident.find('.');
+            if (dot == std::string::npos) return std::nullopt;
+            const Entry *entry = get_entry(ident.substr(0, dot));
+            if (!entry) return std::nullopt;
+            const Field *f = entry->field(ident.substr(dot + 1));
+            if (!f) return std::nullopt;
+            constexpr uint8_t probe[sizeof(uint64_t)]{};
+            const bool fits = Config::visit_field(f->ty, probe, [](auto v) {
+                return sizeof(v) == sizeof(T);
+            });
+            if (!fits) return std::nullopt;
+            return column<T>(*entry, offsetof(PacketSlot, data) + f->offset, range);
+        }
+
+        template<typename T>
+        [[nodiscard]] std::optional<Column<T>> field(const std::string &ident) const {
+            return field<T>(ident, all());
+        }
+
+        /**
+         * @return Host receive time, in steady_clock nanoseconds, of every packet of `entry`.
+         */
+        [[nodiscard]] Column<int64_t> host_times(const Entry &entry, const SlotRange range) const {
+            return column<int64_t>(entry, offsetof(PacketSlot, host_monotonic_ns), range);
+        }
+
+        /**
+         * @return The car's timestamp of every packet of `entry`.
+         */
+        [[nodiscard]] Column<int32_t> car_times(const Entry &entry, const SlotRange range) const {
+            return column<int32_t>(entry, offsetof(PacketSlot, car_timestamp), range);
+        }
+
+    private:
+        explicit SessionReader(MappedFile file) : file(std::move(file)) {
+        }
+
+        bool parse_header();
+        void load_index();
+
+        template<typename T>
+        [[nodiscard]] Column<T> column(const Entry &entry, const size_t offset, SlotRange range) const {
+            range.last = std::min(range.last, slots);
+            range.first = std::min(range.first, range.last);
+            return Column<T>(slot_base + range.first * SESSION_SLOT_SIZE, slot_base + range.last * SESSION_SLOT_SIZE,
+                             static_cast<uint8_t>(entry.id), offset);
+        }
+
+        MappedFile file;
+
+        const uint8_t *slot_base = nullptr;
+        size_t slots = 0;
+        std::vector<Entry> entries;
+        // every index slot in the file, oldest first
+        std::vector<IndexSlot> index;
+    };
+} // DS
+
+#endif //SESSIONLOG_H
@@ -0,0 +1,210 @@
+/* date = October 17, 2026 10:50 PM */
+
+
+#include "SyntheticReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <numbers>
+#include <thread>
+
+namespace DS {
+    // bytes of a frame left for buffer fields, after the header, type, length and timestamp
+    static constexpr size_t SYNTHETIC_FIELD_BYTES = MSG_LENGTH - DATA_OFFSET;
+
+    static SyntheticReader::Waveform parse_waveform(const std::string &name, const std::string &s) {
+        if (s == "sine") return SyntheticReader::Sine;
+        if (s == "ramp") return SyntheticReader::Ramp;
+        if (s == "noise") return SyntheticReader::Noise;
+        std::cerr << "Invalid waveform \"" << s << "\" for synthetic buffer " << name << "!\n";
+        exit(-1);
+    }
+
+    static double check_probability(const double p, const char *key) {
+        if (p < 0 || p > 1) {
+            std::cerr << "Invalid synthetic " << key << " " << p << ", must be between 0 and 1!\n";
+            exit(-1);
+        }
+        return p;
+    }
+
+    // rounds and saturates, so a range wider than the field type pins at its limits instead of wrapping
+    template<typename V>
+    static V convert(const double v) {
+        if constexpr (std::is_floating_point_v<V>) {
+            return static_cast<V>(v);
+        } else {
+            if (v <= static_cast<double>(std::numeric_limits<V>::lowest())) return std::numeric_limits<V>::lowest();
+            if (v >= static_cast<double>(std::numeric_limits<V>::max())) return std::numeric_limits<V>::max();
+            return static_cast<V>(std::round(v));
+        }
+    }
+
+    SyntheticReader::SyntheticReader(const Config &config, const double speed)
+        : speed(speed), unix_start(std::time(nullptr)) {
+        const auto settings = config.get_table()["synthetic"];
+        // a buffer's own table first, then the defaults
+        auto option = [&settings](const std::string &name, const char *key) {
+            const auto v = settings[name][key];
+            return v ? v : settings[key];
+        };
+
+        for (const auto &[name, entry]: config.get_entries()) {
+            const double rate = option(name, "rate").value_or(50.0);
+            if (rate <= 0) continue;
+
+            Stream s{};
+            s.id = static_cast<uint8_t>(*config.get_id_of(name));
+            s.waveform = parse_waveform(name, option(name, "waveform").value_or(std::string{"sine"}));
+            s.period = option(name, "period").value_or(10.0);
+            s.min = option(name, "min").value_or(0.0);
+            s.max = option(name, "max").value_or(100.0);
+            s.interval_ns = 1e9 / rate;
+            if (s.period <= 0) {
+                std::cerr << "Invalid synthetic period " << s.period << " for buffer " << name << "!\n";
+                exit(-1);
+            }
+
+            const auto &fields = entry.get_fields();
+            size_t i = 0;
+            for (const auto &[field_name, field]: fields) {
+                if (static_cast<size_t>(field.offset + field.size) > SYNTHETIC_FIELD_BYTES) {
+                    std::cerr << "Synthetic: " << name << "." << field_name << " doesn't fit in a frame, left at 0\n";
+                    continue;
+                }
+                s.signals.push_back({field.ty, static_cast<size_t>(field.offset),
+                                     static_cast<double>(i++) / static_cast<double>(fields.size())});
+            }
+            streams.push_back(std::move(s));
+        }
+        if (streams.empty()) {
+            std::cerr << "Synthetic: no buffers to generate, every rate is 0 or the config has no buffers!\n";
+            exit(-1);
+        }
+        // spread the first packets out instead of sending one of each at once
+        for (size_t i = 0; i < streams.size(); i++) {
+            streams[i].next_ns = streams[i].interval_ns * static_cast<double>(i) / static_cast<double>(streams.size());
+        }
+
+        rng.seed(settings["seed"].value_or<uint64_t>(1));
+        if (const double p = check_probability(settings["bit_error_rate"].value_or(0.0), "bit_error_rate"); p > 0) {
+            bit_errors.emplace(p);
+            until_bit_error = (*bit_errors)(rng);
+        }
+        if (const double p = check_probability(settings["drop_rate"].value_or(0.0), "drop_rate"); p > 0) {
+            drops.emplace(p);
+            until_drop = (*drops)(rng);
+        }
+
+        double total = 0;
+        for (const Stream &s: streams) total += 1e9 / s.interval_ns;
+        if (speed > 0) {
+            printf("Generating %zu buffers, %g packets per second\n", streams.size(), total * speed);
+        } else {
+            printf("Generating %zu buffers as fast as possible\n", streams.size());
+        }
+    }
+
+    double SyntheticReader::sample(const Stream &s, const Signal &sig, const double t) {
+        switch (s.waveform) {
+            case Sine:
+                return 0.5 + 0.5 * std::sin(2 * std::numbers::pi * (t / s.period + sig.phase));
+            case Ramp: {
+                const double x = t / s.period + sig.phase;
+                return x - std::floor(x);
+            }
+            case Noise:
+                break;
+        }
+        return std::uniform_real_distribution<double>{}(rng);
+    }
+
+    void SyntheticReader::next_frame() {
+        Stream &s = *std::ranges::min_element(streams, {}, &Stream::next_ns);
+        frame_ns = s.next_ns;
+        s.next_ns += s.interval_ns;
+
+        uint8_t msg[MSG_LENGTH]{};
+        memcpy(msg, "UKSC", 4);
+        msg[MESSAGE_TYPE_BYTE] = s.id;
+        const double t = frame_ns / 1e9;
+        const auto car_time = static_cast<int32_t>(unix_start + static_cast<int64_t>(t));
+        memcpy(&msg[TIME_OFFSET], &car_time, sizeof(car_time));
+
+        for (const Signal &sig: s.signals) {
+            const double v = s.min + (s.max - s.min) * sample(s, sig, t);
+            constexpr uint8_t probe[sizeof(uint64_t)]{};
+            Config::visit_field(sig.ty, probe, [&](auto tag) {
+                const auto x = convert<decltype(tag)>(v);
+                memcpy(&msg[DATA_OFFSET + sig.offset], &x, sizeof(x));
+            });
+        }
+        rs.Encode(msg, frame);
+
+        // the radio link's faults, after encoding so FEC sees them like real ones
+        frame_len = 0;
+        for (size_t i = 0; i < BUFFER_LENGTH; i++) {
+            uint8_t b = frame[i];
+            if (drops) {
+                if (until_drop == 0) {
+                    until_drop = (*drops)(rng);
+                    continue;
+                }
+                until_drop--;
+            }
+            if (bit_errors) {
+                if (until_bit_error == 0) {
+                    b ^= static_cast<uint8_t>(1u << (rng() & 7));
+                    until_bit_error = (*bit_errors)(rng);
+                } else {
+                    until_bit_error--;
+                }
+            }
+            frame[frame_len++] = b;
+        }
+        frame_pos = 0;
+    }
+
+    int SyntheticReader::read_bytes(std::span<uint8_t> out, const unsigned int timeout_ms) {
+        const auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms);
+        size_t count = 0;
+        while (count < out.size()) {
+            if (frame_pos == frame_len) {
+                next_frame();
+            }
+            if (!start) {
+                start = Clock::now();
+            }
+
+            if (speed > 0) {
+                const auto when = *start + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(frame_ns / 1e9 / speed));
+                if (when > Clock::now()) {
+                    // hand out what is ready now rather than holding it back for later frames
+                    if (count > 0) break;
+                    if (when > deadline) {
+                        std::this_thread::sleep_until(deadline);
+                        return 0;
+                    }
+                    std::this_thread::sleep_until(when);
+                }
+            }
+
+            const size_t n = std::min(frame_len - frame_pos, out.size() - count);
+            memcpy(out.data() + count, frame + frame_pos, n);
+            frame_pos += n;
+            count += n;
+        }
+        return static_cast<int>(count);
+    }
+
+    uint8_t SyntheticReader::get_byte() {
+        uint8_t b = 0;
+        read_bytes({&b, 1}, READ_TIMEOUT_MS);
+        return b;
+    }
+} // DS
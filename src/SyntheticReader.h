@@ -0,0 +1,133 @@
+/* date = October 17, 2026 10:50 PM */
+
+
+#ifndef SYNTHETICREADER_H
+#define SYNTHETICREADER_H
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "Config.h"
+#include "IOSerial.h"
+#include "RS-FEC.h"
+#include "common.h"
+
+namespace DS {
+
+/**
+ * Generates valid, RS-FEC encoded frames for every buffer in a config, in place of the serial port. Used to load test
+ * ingest, FEC and logging with the same mix of packets the car sends.
+ *
+ * Everything is set in the optional `[synthetic]` table of the config file; a table named after a buffer overrides the
+ * defaults for that buffer alone:
+ * ```toml
+ * [synthetic]
+ * rate = 50               # packets per second of each buffer
+ * waveform = "sine"       # "sine", "ramp" or "noise"
+ * period = 10.0           # seconds per cycle of "sine" and "ramp"
+ * min = 0.0               # range of every field
+ * max = 100.0
+ * bit_error_rate = 0.0    # chance that any sent byte has one bit flipped
+ * drop_rate = 0.0         # chance that any byte is never sent
+ * seed = 1
+ *
+ * [synthetic.gps]
+ * rate = 5
+ * waveform = "ramp"
+ * ```
+ *
+ * `speed` scales every rate: 1 sends at the configured rates, 100 a hundred times as often, and 0 as fast as frames can
+ * be built. Field values follow generated time, not the wall clock, so the same seed always gives the same stream.
+ */
+class SyntheticReader : public IOSerial {
+public:
+    enum Waveform {
+        Sine,
+        Ramp,
+        Noise,
+    };
+
+    /**
+     * Errors in `[synthetic]` are fatal, like failing to open a serial port.
+     * @param config Buffers to generate; only read while constructing.
+     * @param speed Multiplier on every rate, or 0 for as fast as possible.
+     */
+    SyntheticReader(const Config &config, double speed);
+    ~SyntheticReader() override = default;
+
+    int available() override {
+        return 1;
+    }
+
+    uint8_t get_byte() override;
+
+    int read_bytes(std::span<uint8_t> out, unsigned int timeout_ms) override;
+
+    // there is no radio to talk to, so anything sent is dropped
+    bool put(const std::string &s) override {
+        (void) s;
+        return true;
+    }
+
+    bool put_byte(char c) override {
+        (void) c;
+        return true;
+    }
+
+    bool put_bytes(const char *buf, int len) override {
+        (void) buf;
+        (void) len;
+        return true;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Signal {
+        Config::FieldType ty;
+        size_t offset;
+        // spreads the fields of a buffer out along the waveform, so they don't all read the same
+        double phase;
+    };
+
+    struct Stream {
+        uint8_t id;
+        std::vector<Signal> signals;
+        Waveform waveform;
+        double min, max, period;
+        // generated nanoseconds between packets, and when the next one is due
+        double interval_ns;
+        double next_ns;
+    };
+
+    // encodes the next due packet into `frame`, then applies drops and bit errors to it
+    void next_frame();
+    // value of a waveform at generated time `t` seconds, in [0, 1]
+    double sample(const Stream &s, const Signal &sig, double t);
+
+    double speed;
+    std::optional<Clock::time_point> start;
+    // car timestamps count from here, in unix seconds
+    int64_t unix_start;
+    std::vector<Stream> streams;
+
+    // generated time of the frame in `frame`
+    double frame_ns = 0;
+    uint8_t frame[BUFFER_LENGTH]{};
+    size_t frame_len = 0;
+    // bytes of `frame` already handed out; a finished frame means a new one is needed
+    size_t frame_pos = 0;
+    RS::ReedSolomon<MSG_LENGTH, ECC_LENGTH> rs{};
+
+    std::mt19937_64 rng;
+    // bytes left before the next flipped and next dropped byte, drawn so most bytes cost nothing
+    std::optional<std::geometric_distribution<uint64_t>> bit_errors, drops;
+    uint64_t until_bit_error = 0, until_drop = 0;
+};
+
+} // DS
+
+#endif //SYNTHETICREADER_H
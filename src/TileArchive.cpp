@@ -0,0 +1,143 @@
+/* date = October 17, 2026 11:50 PM */
+
+
+#include "TileArchive.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iostream>
+
+namespace DS {
+    uint64_t tile_slot_hash(const TileKey &key) {
+        // splitmix64 finalizer; part of the file format, so it can't be std::hash
+        uint64_t h = static_cast<uint64_t>(key.z) << 58 ^ static_cast<uint64_t>(key.x) << 29 ^
+                     static_cast<uint64_t>(key.y);
+        h = (h ^ h >> 30) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ h >> 27) * 0x94d049bb133111ebull;
+        return h ^ h >> 31;
+    }
+
+    std::optional<TileArchive> TileArchive::open(const std::filesystem::path &path) {
+        auto file = MappedFile::open(path);
+        if (!file) return std::nullopt;
+
+        TileArchiveHeader h{};
+        if (file->size() >= sizeof(h)) {
+            memcpy(&h, file->data(), sizeof(h));
+        }
+        if (file->size() < sizeof(h) || memcmp(h.magic, TILE_ARCHIVE_MAGIC, sizeof(h.magic)) != 0) {
+            std::cerr << "Tiles: " << path << " is not a tile archive\n";
+            return std::nullopt;
+        }
+        if (h.version != TILE_ARCHIVE_VERSION) {
+            std::cerr << "Tiles: " << path << " is version " << h.version << ", expected " << TILE_ARCHIVE_VERSION
+                      << "\n";
+            return std::nullopt;
+        }
+        if (!std::has_single_bit(h.slots) || h.index_offset < TILE_ARCHIVE_HEADER_SIZE ||
+            h.index_offset % alignof(TileIndexSlot) != 0 || h.index_offset > file->size() ||
+            (file->size() - h.index_offset) / sizeof(TileIndexSlot) < h.slots) {
+            std::cerr << "Tiles: " << path << " has a damaged index\n";
+            return std::nullopt;
+        }
+        return TileArchive{std::move(*file)};
+    }
+
+    std::optional<std::span<const uint8_t>> TileArchive::find(const TileKey &key) const {
+        const uint64_t mask = header().slots - 1;
+        const TileIndexSlot *slots = index();
+        uint64_t i = tile_slot_hash(key) & mask;
+        // bounded, in case a damaged file has no empty slot
+        for (uint64_t probes = 0; probes <= mask; probes++, i = (i + 1) & mask) {
+            const TileIndexSlot &s = slots[i];
+            if (s.length == 0) return std::nullopt;
+            if (s.z == static_cast<uint32_t>(key.z) && s.x == static_cast<uint32_t>(key.x) &&
+                s.y == static_cast<uint32_t>(key.y)) {
+                if (s.offset > header().index_offset || header().index_offset - s.offset < s.length) {
+                    return std::nullopt;
+                }
+                return std::span{file.data() + s.offset, s.length};
+            }
+        }
+        return std::nullopt;
+    }
+
+    void TileArchive::for_each(const std::function<void(const TileKey &, std::span<const uint8_t>)> &f) const {
+        const TileIndexSlot *slots = index();
+        for (uint64_t i = 0; i < header().slots; i++) {
+            const TileIndexSlot &s = slots[i];
+            if (s.length == 0) continue;
+            const TileKey key{static_cast<int>(s.z), static_cast<int>(s.x), static_cast<int>(s.y)};
+            if (const auto bytes = find(key)) {
+                f(key, *bytes);
+            }
+        }
+    }
+
+    TileArchiveWriter::~TileArchiveWriter() {
+        if (file) {
+            close();
+        }
+    }
+
+    bool TileArchiveWriter::open(const std::filesystem::path &path) {
+        file = fopen(path.string().c_str(), "wb");
+        if (!file) {
+            std::cerr << "Tiles: could not create " << path << "\n";
+            return false;
+        }
+        // the header is written last, once the index is
+        const uint8_t blank[TILE_ARCHIVE_HEADER_SIZE]{};
+        failed = fwrite(blank, 1, sizeof(blank), file) != sizeof(blank);
+        return true;
+    }
+
+    bool TileArchiveWriter::add(const TileKey &key, const std::span<const uint8_t> bytes) {
+        if (bytes.empty() || !keys.insert(key).second) return true;
+
+        if (fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size()) {
+            failed = true;
+            return false;
+        }
+        entries.push_back({static_cast<uint32_t>(key.z), static_cast<uint32_t>(key.x), static_cast<uint32_t>(key.y),
+                           static_cast<uint32_t>(bytes.size()), end});
+        end += bytes.size();
+        return true;
+    }
+
+    bool TileArchiveWriter::close() {
+        TileArchiveHeader h{};
+        memcpy(h.magic, TILE_ARCHIVE_MAGIC, sizeof(h.magic));
+        h.version = TILE_ARCHIVE_VERSION;
+        h.count = static_cast<uint32_t>(entries.size());
+        h.slots = std::bit_ceil(std::max<uint64_t>(entries.size() * 2, 16));
+
+        // keep the slots aligned in the mapping
+        const uint64_t padding = (alignof(TileIndexSlot) - end % alignof(TileIndexSlot)) % alignof(TileIndexSlot);
+        const uint8_t zeros[alignof(TileIndexSlot)]{};
+        failed |= fwrite(zeros, 1, padding, file) != padding;
+        h.index_offset = end + padding;
+
+        std::vector<TileIndexSlot> slots(h.slots);
+        const uint64_t mask = h.slots - 1;
+        for (const TileIndexSlot &e: entries) {
+            const TileKey key{static_cast<int>(e.z), static_cast<int>(e.x), static_cast<int>(e.y)};
+            uint64_t i = tile_slot_hash(key) & mask;
+            while (slots[i].length != 0) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = e;
+        }
+        failed |= fwrite(slots.data(), sizeof(TileIndexSlot), slots.size(), file) != slots.size();
+        failed |= fseek(file, 0, SEEK_SET) != 0;
+        failed |= fwrite(&h, sizeof(h), 1, file) != 1;
+        failed |= fclose(file) != 0;
+        file = nullptr;
+
+        if (failed) {
+            std::cerr << "Tiles: writing the archive failed\n";
+        }
+        return !failed;
+    }
+} // DS
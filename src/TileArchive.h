@@ -0,0 +1,149 @@
+/* date = October 17, 2026 11:50 PM */
+
+
+#ifndef TILEARCHIVE_H
+#define TILEARCHIVE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+#include "MappedFile.h"
+
+namespace DS {
+    struct TileKey {
+        int z;
+        int x;
+        int y;
+
+        bool operator==(const TileKey &) const = default;
+    };
+
+    struct TileKeyHash {
+        size_t operator()(const TileKey &k) const {
+            return std::hash<uint64_t>{}(static_cast<uint64_t>(k.z) << 58 ^ static_cast<uint64_t>(k.x) << 29 ^
+                                         static_cast<uint64_t>(k.y));
+        }
+    };
+
+    /*
+     * Tile archive ("*.dstiles") layout, integers in host (little-endian) byte order:
+     *   header  TileArchiveHeader, TILE_ARCHIVE_HEADER_SIZE bytes
+     *   tiles   the tile images (PNG), back to back
+     *   index   `slots` TileIndexSlot entries, an open-addressing hash table; a tile's probe starts at
+     *           `tile_slot_hash(key) & (slots - 1)` and moves one slot on until it finds the tile or an empty slot
+     */
+    constexpr char TILE_ARCHIVE_MAGIC[8] = {'D', 'S', 'T', 'I', 'L', 'E', 'S', 0};
+    constexpr uint32_t TILE_ARCHIVE_VERSION = 1;
+    constexpr size_t TILE_ARCHIVE_HEADER_SIZE = 64;
+
+    struct TileArchiveHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t count;
+        uint64_t index_offset;
+        // power of two, at least twice `count`
+        uint64_t slots;
+        uint8_t reserved[32];
+    };
+
+    static_assert(sizeof(TileArchiveHeader) == TILE_ARCHIVE_HEADER_SIZE);
+
+    struct TileIndexSlot {
+        uint32_t z, x, y;
+        // 0 for an empty slot
+        uint32_t length;
+        uint64_t offset;
+    };
+
+    static_assert(sizeof(TileIndexSlot) == 24);
+
+    uint64_t tile_slot_hash(const TileKey &key);
+
+    /**
+     * A tile archive mapped into memory. Finding a tile is one hash and, almost always, one slot read.
+     */
+    class TileArchive {
+    public:
+        /**
+         * Errors are printed.
+         * @return The archive, or std::nullopt if it can't be opened or isn't a tile archive.
+         */
+        static std::optional<TileArchive> open(const std::filesystem::path &path);
+
+        /**
+         * @return The tile's image bytes, pointing into the mapping, or std::nullopt if the archive doesn't have it.
+         */
+        [[nodiscard]] std::optional<std::span<const uint8_t>> find(const TileKey &key) const;
+
+        [[nodiscard]] size_t size() const {
+            return header().count;
+        }
+
+        /**
+         * Calls `f(key, bytes)` for every tile, in index order.
+         */
+        void for_each(const std::function<void(const TileKey &, std::span<const uint8_t>)> &f) const;
+
+    private:
+        explicit TileArchive(MappedFile file) : file(std::move(file)) {}
+
+        [[nodiscard]] const TileArchiveHeader &header() const {
+            return *reinterpret_cast<const TileArchiveHeader *>(file.data());
+        }
+
+        [[nodiscard]] const TileIndexSlot *index() const {
+            return reinterpret_cast<const TileIndexSlot *>(file.data() + header().index_offset);
+        }
+
+        MappedFile file;
+    };
+
+    /**
+     * Builds a tile archive. Tiles are written as they are added; the index is written by `close`.
+     */
+    class TileArchiveWriter {
+    public:
+        TileArchiveWriter() = default;
+        ~TileArchiveWriter();
+
+        TileArchiveWriter(const TileArchiveWriter &) = delete;
+        TileArchiveWriter &operator=(const TileArchiveWriter &) = delete;
+
+        /**
+         * Errors are printed.
+         * @return false if the file couldn't be created.
+         */
+        bool open(const std::filesystem::path &path);
+
+        /**
+         * Adds a tile, unless one with the same key is already in.
+         * @return false if the write failed.
+         */
+        bool add(const TileKey &key, std::span<const uint8_t> bytes);
+
+        [[nodiscard]] bool contains(const TileKey &key) const {
+            return keys.contains(key);
+        }
+
+        /**
+         * Writes the index and header and closes the file.
+         * @return false if a write failed.
+         */
+        bool close();
+
+    private:
+        FILE *file = nullptr;
+        uint64_t end = TILE_ARCHIVE_HEADER_SIZE;
+        std::vector<TileIndexSlot> entries;
+        std::unordered_set<TileKey, TileKeyHash> keys;
+        bool failed = false;
+    };
+} // DS
+
+#endif //TILEARCHIVE_H
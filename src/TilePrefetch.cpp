@@ -0,0 +1,273 @@
+/* date = October 17, 2026 11:50 PM */
+
+
+#include "TilePrefetch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "GenerateMap.h"
+#include "TileArchive.h"
+#include "stb_image.h"
+
+namespace DS {
+    // downloads at once; tile servers generally ask clients to keep this low
+    static constexpr unsigned TILE_PREFETCH_THREADS = 4;
+    static constexpr int TILE_PREFETCH_ATTEMPTS = 3;
+    // refuse areas this big, which are almost always a mistake in the box or zoom range
+    static constexpr size_t TILE_PREFETCH_LIMIT = 100000;
+
+    using TileSet = std::unordered_set<TileKey, TileKeyHash>;
+
+    static std::optional<std::vector<std::pair<double, double>>> read_route(const std::filesystem::path &path) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Tiles: could not open route " << path << "\n";
+            return std::nullopt;
+        }
+        std::vector<std::pair<double, double>> points;
+        std::string line;
+        for (int n = 1; std::getline(file, line); n++) {
+            line = line.substr(0, line.find('#'));
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            double lat, lon;
+            if (sscanf(line.c_str(), " %lf , %lf", &lat, &lon) != 2) {
+                std::cerr << "Tiles: " << path << ":" << n << " is not \"lat,lon\"\n";
+                return std::nullopt;
+            }
+            points.emplace_back(lat, lon);
+        }
+        return points;
+    }
+
+    static void add_around(TileSet &tiles, const int z, const double fx, const double fy, const int radius) {
+        const int n = 1 << z;
+        const int cx = static_cast<int>(std::floor(fx));
+        const int cy = static_cast<int>(std::floor(fy));
+        for (int y = std::max(cy - radius, 0); y <= std::min(cy + radius, n - 1); y++) {
+            for (int x = cx - radius; x <= cx + radius; x++) {
+                tiles.insert({z, (x % n + n) % n, y});
+            }
+        }
+    }
+
+    static void add_route(TileSet &tiles, const std::vector<std::pair<double, double>> &route, const int z,
+                          const int radius) {
+        for (size_t i = 0; i < route.size(); i++) {
+            const auto [lat0, lon0] = route[i];
+            const auto [lat1, lon1] = route[std::min(i + 1, route.size() - 1)];
+            const double x0 = lon_to_tile(lon0, z), y0 = lat_to_tile(lat0, z);
+            const double x1 = lon_to_tile(lon1, z), y1 = lat_to_tile(lat1, z);
+            // half a tile at a time, so no tile the segment crosses is skipped
+            const int steps = static_cast<int>(std::ceil(std::max(std::abs(x1 - x0), std::abs(y1 - y0)) * 2));
+            for (int s = 0; s <= steps; s++) {
+                const double t = steps ? static_cast<double>(s) / steps : 0;
+                add_around(tiles, z, x0 + (x1 - x0) * t, y0 + (y1 - y0) * t, radius);
+            }
+            // already refused; a long route at a high zoom would otherwise keep going for a while
+            if (tiles.size() > TILE_PREFETCH_LIMIT) return;
+        }
+    }
+
+    // tiles a box covers at one zoom level; columns wrap around the antimeridian, so at most one full turn is kept
+    struct TileRange {
+        int x0, x1, y0, y1;
+
+        [[nodiscard]] size_t size() const {
+            return x1 < x0 || y1 < y0 ? 0 : static_cast<size_t>(x1 - x0 + 1) * static_cast<size_t>(y1 - y0 + 1);
+        }
+    };
+
+    static TileRange bbox_range(const std::array<double, 4> &bbox, const int z) {
+        const int n = 1 << z;
+        const auto [south, west, north, east] = bbox;
+        const int x0 = static_cast<int>(std::floor(lon_to_tile(west, z)));
+        const int x1 = std::min(static_cast<int>(std::floor(lon_to_tile(east, z))), x0 + n - 1);
+        const int y0 = std::clamp(static_cast<int>(std::floor(lat_to_tile(north, z))), 0, n - 1);
+        const int y1 = std::clamp(static_cast<int>(std::floor(lat_to_tile(south, z))), 0, n - 1);
+        return {x0, x1, y0, y1};
+    }
+
+    static void add_bbox(TileSet &tiles, const TileRange &range, const int z) {
+        const int n = 1 << z;
+        for (int y = range.y0; y <= range.y1; y++) {
+            for (int x = range.x0; x <= range.x1; x++) {
+                tiles.insert({z, (x % n + n) % n, y});
+            }
+        }
+    }
+
+    static size_t append_bytes(void *ptr, const size_t size, const size_t nmemb, void *out) {
+        auto *bytes = static_cast<std::vector<uint8_t> *>(out);
+        const auto *p = static_cast<const uint8_t *>(ptr);
+        bytes->insert(bytes->end(), p, p + size * nmemb);
+        return size * nmemb;
+    }
+
+    // whether the bytes look like a tile the map can draw, rather than say an error page served with a 200
+    static bool is_tile(const std::span<const uint8_t> bytes) {
+        int w, h, channels;
+        return stbi_info_from_memory(bytes.data(), static_cast<int>(bytes.size()), &w, &h, &channels) &&
+               w == TILE_SIZE && h == TILE_SIZE;
+    }
+
+    static bool download(CURL *curl, const std::string &url, std::vector<uint8_t> &out) {
+        for (int attempt = 0; attempt < TILE_PREFETCH_ATTEMPTS; attempt++) {
+            out.clear();
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &out);
+            long status = 0;
+            if (curl_easy_perform(curl) == CURLE_OK &&
+                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status) == CURLE_OK && status == 200 &&
+                is_tile(out)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int prefetch_tiles(const TilePrefetchRequest &request) {
+        if (request.route.empty() && !request.bbox) {
+            std::cerr << "Tiles: give the area to prefetch with --route or --bbox\n";
+            return 1;
+        }
+        if (request.min_zoom < 0 || request.max_zoom > MAX_ZOOM || request.min_zoom > request.max_zoom) {
+            std::cerr << "Tiles: zoom range must be within 0-" << MAX_ZOOM << "\n";
+            return 1;
+        }
+
+        std::vector<std::pair<double, double>> route;
+        if (!request.route.empty()) {
+            auto points = read_route(request.route);
+            if (!points) return 1;
+            route = std::move(*points);
+        }
+        const auto too_many = [] {
+            std::cerr << "Tiles: more than " << TILE_PREFETCH_LIMIT << " tiles, use a smaller area or zoom range\n";
+            return 1;
+        };
+        // counted before anything is inserted, since a big box at a high zoom covers billions of tiles
+        if (request.bbox) {
+            size_t total = 0;
+            for (int z = request.min_zoom; z <= request.max_zoom; z++) {
+                total += bbox_range(*request.bbox, z).size();
+                if (total > TILE_PREFETCH_LIMIT) return too_many();
+            }
+        }
+        const size_t side = 2 * static_cast<size_t>(request.radius) + 1;
+        if (!route.empty() && side * side > TILE_PREFETCH_LIMIT) return too_many();
+
+        TileSet wanted;
+        for (int z = request.min_zoom; z <= request.max_zoom; z++) {
+            add_route(wanted, route, z, request.radius);
+            if (request.bbox) {
+                add_bbox(wanted, bbox_range(*request.bbox, z), z);
+            }
+            if (wanted.size() > TILE_PREFETCH_LIMIT) return too_many();
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        std::filesystem::path temp = request.output;
+        temp += ".partial";
+        TileArchiveWriter writer;
+        if (!writer.open(temp)) return 1;
+
+        // keep what the archive and the tile cache already have
+        size_t kept = 0;
+        if (std::filesystem::exists(request.output)) {
+            if (const auto old = TileArchive::open(request.output)) {
+                // tiles that don't decode (stored by older versions) are dropped, and downloaded again if wanted
+                old->for_each([&](const TileKey &key, const std::span<const uint8_t> bytes) {
+                    if (is_tile(bytes) && writer.add(key, bytes)) kept++;
+                });
+            }
+        }
+        std::vector<TileKey> missing;
+        for (const TileKey &key: wanted) {
+            if (writer.contains(key)) continue;
+            const auto cached = std::filesystem::path(TILE_DIR) / std::to_string(key.z) / std::to_string(key.x) /
+                                (std::to_string(key.y) + ".png");
+            std::error_code ec;
+            if (std::filesystem::file_size(cached, ec) > 0 && !ec) {
+                std::ifstream file(cached, std::ios::binary);
+                const std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(file), {}};
+                if (is_tile(bytes) && writer.add(key, bytes)) {
+                    kept++;
+                    continue;
+                }
+            }
+            missing.push_back(key);
+        }
+        // neighbouring tiles together, which keeps the archive (and its page cache) in map order
+        std::ranges::sort(missing, {}, [](const TileKey &k) { return std::tuple{k.z, k.y, k.x}; });
+        printf("Prefetching %zu tiles at zoom %d-%d: %zu already stored, %zu to download from %s\n", wanted.size(),
+               request.min_zoom, request.max_zoom, kept, missing.size(), request.url.c_str());
+
+        // curl_easy_init would otherwise do this, and it isn't safe to do from several threads at once
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        std::mutex write_lock;
+        std::atomic<size_t> next{0}, done{0}, failed{0};
+        auto work = [&] {
+            CURL *curl = curl_easy_init();
+            if (!curl) {
+                failed.fetch_add(1);
+                return;
+            }
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, append_bytes);
+            curl_easy_setopt(curl, CURLOPT_USERAGENT, "TileStitcher/1.0");
+            // a stalled connection counts as a failed attempt instead of holding up this thread for good
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, TILE_CONNECT_TIMEOUT_MS);
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, TILE_TIMEOUT_MS);
+            curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+            std::vector<uint8_t> bytes;
+            for (size_t i; (i = next.fetch_add(1)) < missing.size();) {
+                const TileKey &key = missing[i];
+                if (!download(curl, tile_url(request.url, key.z, key.x, key.y), bytes)) {
+                    std::cerr << "Tiles: could not download " << key.z << "/" << key.x << "/" << key.y << "\n";
+                    failed.fetch_add(1);
+                    continue;
+                }
+                std::lock_guard guard(write_lock);
+                if (!writer.add(key, bytes)) failed.fetch_add(1);
+                const size_t n = done.fetch_add(1) + 1;
+                if (n % 100 == 0) {
+                    printf("%zu / %zu\n", n, missing.size());
+                }
+            }
+            curl_easy_cleanup(curl);
+        };
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < std::min<size_t>(TILE_PREFETCH_THREADS, missing.size()); i++) {
+            threads.emplace_back(work);
+        }
+        for (auto &t: threads) {
+            t.join();
+        }
+
+        // the old archive, if any, is only replaced by a complete one; a half-written one is no use to keep
+        std::error_code ec;
+        if (!writer.close()) {
+            std::filesystem::remove(temp, ec);
+            return 1;
+        }
+        std::filesystem::rename(temp, request.output, ec);
+        if (ec) {
+            std::cerr << "Tiles: could not replace " << request.output << ": " << ec.message() << "\n";
+            std::filesystem::remove(temp, ec);
+            return 1;
+        }
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("Stored %zu tiles in %s (%zu downloaded, %zu failed) in %.1f s\n", kept + done.load(),
+               request.output.string().c_str(), done.load(), failed.load(), secs);
+        return failed.load() ? 1 : 0;
+    }
+} // DS
@@ -0,0 +1,38 @@
+/* date = October 17, 2026 11:50 PM */
+
+
+#ifndef TILEPREFETCH_H
+#define TILEPREFETCH_H
+
+#include <array>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace DS {
+    struct TilePrefetchRequest {
+        // archive to create, or to add to if it exists
+        std::filesystem::path output;
+        // the area: a route file ("lat,lon" per line, '#' starts a comment), a box, or both
+        std::filesystem::path route;
+        // south latitude, west longitude, north latitude, east longitude
+        std::optional<std::array<double, 4>> bbox;
+        int min_zoom;
+        int max_zoom;
+        // tiles added on each side of the route, so the map isn't cut off right next to it
+        int radius;
+        // tile server, with {z}, {x} and {y} in place of the tile's coordinates
+        std::string url;
+    };
+
+    /**
+     * Fills a tile archive with every tile of an area at every zoom in a range, for map display with no network.
+     *
+     * Tiles already in the archive or in the on-disk tile cache are kept; the rest are downloaded in parallel.
+     * The archive is built next to `output` and only replaces it once complete.
+     * @return Process exit code: 0 if every tile was stored.
+     */
+    int prefetch_tiles(const TilePrefetchRequest &request);
+} // DS
+
+#endif //TILEPREFETCH_H
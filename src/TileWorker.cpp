@@ -0,0 +1,241 @@
+/* date = October 17, 2026 11:20 PM */
+
+
+#include "TileWorker.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "stb_image.h"
+
+namespace DS {
+    static size_t append_bytes(void *ptr, const size_t size, const size_t nmemb, void *out) {
+        auto *bytes = static_cast<std::vector<unsigned char> *>(out);
+        const auto *p = static_cast<const unsigned char *>(ptr);
+        bytes->insert(bytes->end(), p, p + size * nmemb);
+        return size * nmemb;
+    }
+
+    static std::optional<Image> decode(const std::span<const unsigned char> png) {
+        int w, h, c;
+        unsigned char *data = stbi_load_from_memory(png.data(), static_cast<int>(png.size()), &w, &h, &c, 4);
+        if (!data) return std::nullopt;
+
+        Image img{w, h, {}};
+        img.px.assign(data, data + w * h * 4);
+        stbi_image_free(data);
+        return img;
+    }
+
+    static std::vector<unsigned char> read_file(const std::filesystem::path &path) {
+        std::ifstream file(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+
+    // `curl` is kept across tiles, so the connection to the tile server stays open
+    static std::optional<Image> fetch(CURL *curl, const TileArchive *archive, const TileKey &key) {
+        if (archive) {
+            if (const auto png = archive->find(key)) {
+                if (auto img = decode(*png)) {
+                    return img;
+                }
+            }
+        }
+
+        const std::filesystem::path path = std::filesystem::path(TILE_DIR) / std::to_string(key.z) /
+                                           std::to_string(key.x) / (std::to_string(key.y) + ".png");
+        if (std::filesystem::exists(path)) {
+            if (auto img = decode(read_file(path))) {
+                return img;
+            }
+            // a download cut short; fetch it again
+            std::filesystem::remove(path);
+        }
+        if (!curl) return std::nullopt;
+
+        const std::string url = tile_url(TILE_URL, key.z, key.x, key.y);
+        std::vector<unsigned char> png;
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &png);
+        if (curl_easy_perform(curl) != CURLE_OK) return std::nullopt;
+        long status = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+        if (status != 200) return std::nullopt;
+
+        auto img = decode(png);
+        if (img) {
+            // only tiles that decode reach the disk cache
+            std::error_code ec;
+            std::filesystem::create_directories(path.parent_path(), ec);
+            std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char *>(png.data()),
+                                                        static_cast<std::streamsize>(png.size()));
+        }
+        return img;
+    }
+
+    TileWorker::TileWorker(const size_t capacity) : capacity(capacity) {
+        worker = std::thread(&TileWorker::run, this);
+    }
+
+    TileWorker::~TileWorker() {
+        {
+            std::lock_guard guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+
+        if (!pages.empty()) {
+            glDeleteTextures(static_cast<GLsizei>(pages.size()), pages.data());
+        }
+    }
+
+    void TileWorker::create_atlas() {
+        GLint max_size = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+        page_size = std::min(TILE_ATLAS_SIZE, std::max<int>(max_size, TILE_SIZE));
+        page_tiles = page_size / TILE_SIZE;
+        const size_t per_page = static_cast<size_t>(page_tiles) * page_tiles;
+        pages.resize((capacity + per_page - 1) / per_page);
+        capacity = pages.size() * per_page;
+
+        glGenTextures(static_cast<GLsizei>(pages.size()), pages.data());
+        for (const GLuint page: pages) {
+            glBindTexture(GL_TEXTURE_2D, page);
+            // linear, so the map stays smooth between zoom levels; no mipmaps, they would blend neighbouring tiles
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, page_size, page_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+        free_slots.resize(capacity);
+        for (size_t i = 0; i < capacity; i++) {
+            // handed out from the back, so the first pages fill first
+            free_slots[i] = static_cast<uint32_t>(capacity - 1 - i);
+        }
+    }
+
+    TileWorker::SlotPlace TileWorker::place(const uint32_t slot) const {
+        const int per_page = page_tiles * page_tiles;
+        const int in_page = static_cast<int>(slot) % per_page;
+        return {pages[slot / per_page], in_page % page_tiles * TILE_SIZE, in_page / page_tiles * TILE_SIZE};
+    }
+
+    TileTexture TileWorker::locate(const uint32_t slot) const {
+        const auto [page, x, y] = place(slot);
+        const float size = static_cast<float>(page_size);
+        const float u = static_cast<float>(x) / size;
+        const float v = static_cast<float>(y) / size;
+        return {page, u, v, u + TILE_SIZE / size, v + TILE_SIZE / size, 1.0f / size};
+    }
+
+    std::optional<TileTexture> TileWorker::peek(const TileKey &key) {
+        const auto it = slots.find(key);
+        if (it == slots.end()) return std::nullopt;
+        lru.splice(lru.begin(), lru, it->second);
+        return locate(it->second->second);
+    }
+
+    std::optional<TileTexture> TileWorker::get(const TileKey &key) {
+        if (auto found = peek(key)) {
+            return found;
+        }
+
+        const auto now = Clock::now();
+        if (const auto it = pending.find(key); it != pending.end() && now < it->second) {
+            return std::nullopt;
+        }
+        pending[key] = Clock::time_point::max();
+        {
+            std::lock_guard guard(lock);
+            if (requests.size() >= TILE_QUEUE_LIMIT) {
+                pending.erase(requests.front());
+                requests.erase(requests.begin());
+            }
+            requests.push_back(key);
+        }
+        wake.notify_one();
+        return std::nullopt;
+    }
+
+    void TileWorker::upload() {
+        std::vector<Result> done;
+        {
+            std::lock_guard guard(lock);
+            done.swap(results);
+        }
+
+        if (pages.empty() && !done.empty()) {
+            create_atlas();
+        }
+        for (Result &r: done) {
+            if (r.image && (r.image->w != TILE_SIZE || r.image->h != TILE_SIZE)) {
+                std::cerr << "Map: tile " << r.key.z << "/" << r.key.x << "/" << r.key.y << " is " << r.image->w
+                          << "x" << r.image->h << ", only " << TILE_SIZE << " pixel tiles are supported\n";
+                r.image.reset();
+            }
+            if (!r.image) {
+                const auto retry = Clock::now() + std::chrono::milliseconds(TILE_RETRY_MS);
+                pending[r.key] = retry;
+                failing_until = retry;
+                continue;
+            }
+            pending.erase(r.key);
+
+            if (free_slots.empty()) {
+                // reuse the slot of the tile drawn longest ago
+                free_slots.push_back(lru.back().second);
+                slots.erase(lru.back().first);
+                lru.pop_back();
+            }
+            const uint32_t slot = free_slots.back();
+            free_slots.pop_back();
+
+            const auto [page, x, y] = place(slot);
+            glBindTexture(GL_TEXTURE_2D, page);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, TILE_SIZE, TILE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE,
+                            r.image->px.data());
+
+            lru.emplace_front(r.key, slot);
+            slots[r.key] = lru.begin();
+        }
+    }
+
+    void TileWorker::run() {
+        CURL *curl = curl_easy_init();
+        if (curl) {
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, append_bytes);
+            curl_easy_setopt(curl, CURLOPT_USERAGENT, "TileStitcher/1.0");
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, TILE_CONNECT_TIMEOUT_MS);
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, TILE_TIMEOUT_MS);
+            // timeouts would otherwise be raised as signals, which aren't safe off the main thread
+            curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        } else {
+            std::cerr << "Map: could not initialize curl, only tiles already on disk will load\n";
+        }
+
+        std::optional<TileArchive> archive;
+        if (std::filesystem::exists(TILE_ARCHIVE)) {
+            archive = TileArchive::open(TILE_ARCHIVE);
+        }
+
+        std::unique_lock guard(lock);
+        for (;;) {
+            wake.wait(guard, [this] { return stopping || !requests.empty(); });
+            if (stopping) break;
+
+            const TileKey key = requests.back();
+            requests.pop_back();
+            guard.unlock();
+            auto img = fetch(curl, archive ? &*archive : nullptr, key);
+            guard.lock();
+            results.push_back({key, std::move(img)});
+        }
+
+        if (curl) {
+            curl_easy_cleanup(curl);
+        }
+    }
+} // DS
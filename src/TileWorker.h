@@ -0,0 +1,117 @@
+/* date = October 17, 2026 11:20 PM */
+
+
+#ifndef TILEWORKER_H
+#define TILEWORKER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "GenerateMap.h"
+#include "TileArchive.h"
+
+namespace DS {
+    /**
+     * Where a cached tile is: its atlas texture and the texture coordinates of its corners.
+     */
+    struct TileTexture {
+        GLuint texture;
+        float u0, v0, u1, v1;
+        // size of one texel in texture coordinates
+        float texel;
+    };
+
+    /**
+     * Loads map tiles on one long-lived thread and keeps the most recently drawn ones in GL texture atlases.
+     *
+     * The UI thread asks for tiles with `get` and turns finished ones into textures with `upload`; the worker looks
+     * each tile up in the prefetched `TILE_ARCHIVE`, then the disk cache in `TILE_DIR`, downloading it there if neither
+     * has it, and decodes it. Each tile is uploaded once, into a free slot of an atlas, so once the tiles around the
+     * car are cached, drawing the map costs no file, network, decode or upload work, and a draw call per atlas page.
+     *
+     * NOTE: everything but the constructor runs on the UI thread with the GL context current, including the
+     * destructor, which deletes the atlases.
+     */
+    class TileWorker {
+    public:
+        explicit TileWorker(size_t capacity = TILE_CACHE_TILES);
+        ~TileWorker();
+
+        TileWorker(const TileWorker &) = delete;
+        TileWorker &operator=(const TileWorker &) = delete;
+
+        /**
+         * @param key Tile to draw.
+         * @return Where it is if it is cached, otherwise std::nullopt and the tile is queued for loading.
+         */
+        std::optional<TileTexture> get(const TileKey &key);
+
+        /**
+         * Like `get`, but never queues the tile. Used for stand-ins while the wanted tile loads.
+         */
+        std::optional<TileTexture> peek(const TileKey &key);
+
+        /**
+         * Uploads every tile the worker finished since the last call. Call once per frame.
+         */
+        void upload();
+
+        /**
+         * @return Whether a tile failed to load recently, most likely because there is no internet.
+         */
+        [[nodiscard]] bool failing() const {
+            return Clock::now() < failing_until;
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Result {
+            TileKey key;
+            std::optional<Image> image;
+        };
+
+        void run();
+        // creates the atlas pages on first use, once the GL context is current
+        void create_atlas();
+        struct SlotPlace {
+            GLuint page;
+            // top left pixel
+            int x, y;
+        };
+        [[nodiscard]] SlotPlace place(uint32_t slot) const;
+        [[nodiscard]] TileTexture locate(uint32_t slot) const;
+
+        // UI thread only
+        size_t capacity;
+        std::vector<GLuint> pages;
+        int page_size = 0;
+        // slots along one side of a page
+        int page_tiles = 0;
+        std::vector<uint32_t> free_slots;
+        // atlas slot of each cached tile, most recently used first
+        std::list<std::pair<TileKey, uint32_t>> lru;
+        std::unordered_map<TileKey, std::list<std::pair<TileKey, uint32_t>>::iterator, TileKeyHash> slots;
+        // tiles asked for but not uploaded, with when they may be asked for again (after a failure)
+        std::unordered_map<TileKey, Clock::time_point, TileKeyHash> pending;
+        Clock::time_point failing_until{};
+
+        // shared with the worker
+        std::mutex lock;
+        std::condition_variable wake;
+        // served newest first
+        std::vector<TileKey> requests;
+        std::vector<Result> results;
+        bool stopping = false;
+
+        std::thread worker;
+    };
+} // DS
+
+#endif //TILEWORKER_H
@@ -0,0 +1,184 @@
+/* date = October 18, 2026 1:45 AM */
+
+
+#include "Uplink.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace DS {
+    static bool finished(const Uplink::State state) {
+        return state == Uplink::State::Acked || state == Uplink::State::Unconfirmed || state == Uplink::State::Failed ||
+               state == Uplink::State::Superseded;
+    }
+
+    Uplink::~Uplink() {
+        close();
+    }
+
+    void Uplink::open(IOSerial *serial) {
+        close();
+        this->serial = serial;
+        this->stopping = false;
+        this->worker = std::thread(&Uplink::run, this);
+    }
+
+    void Uplink::close() {
+        if (!worker.joinable()) return;
+        {
+            std::lock_guard guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+        std::lock_guard guard(lock);
+        std::erase_if(queue, [](const Pending &p) { return p.command.state == State::Queued; });
+    }
+
+    std::optional<uint32_t> Uplink::send(std::string label, const std::span<const uint8_t, UPLINK_BODY_LENGTH> body) {
+        std::lock_guard guard(lock);
+        if (!worker.joinable()) {
+            std::cerr << "Uplink: not connected, \"" << label << "\" was not sent\n";
+            return std::nullopt;
+        }
+        const auto unfinished = static_cast<size_t>(std::ranges::count_if(queue, [](const Pending &p) {
+            return !finished(p.command.state);
+        }));
+        if (unfinished >= UPLINK_QUEUE_LIMIT) {
+            std::cerr << "Uplink: " << unfinished << " commands still waiting, \"" << label << "\" was not sent\n";
+            return std::nullopt;
+        }
+
+        // forget the oldest finished commands beyond the history kept
+        size_t old = queue.size() - unfinished;
+        for (auto it = queue.begin(); old > UPLINK_HISTORY && it != queue.end();) {
+            if (finished(it->command.state)) {
+                it = queue.erase(it);
+                old--;
+            } else {
+                ++it;
+            }
+        }
+
+        const uint32_t sequence = next_sequence++;
+        uint8_t data[MSG_LENGTH]{};
+        memcpy(data, "GCS ", 4);
+        memcpy(data + 4, body.data(), UPLINK_BODY_LENGTH);
+        memcpy(data + 4 + UPLINK_BODY_LENGTH, "UKSC", 4);
+        memcpy(data + UPLINK_SEQUENCE_OFFSET, &sequence, sizeof(sequence));
+
+        Pending &p = queue.emplace_back();
+        p.command = {sequence, std::move(label), State::Queued, 0, Clock::now(), {}, {}};
+        rs.Encode(data, p.frame.data());
+        wake.notify_one();
+        return sequence;
+    }
+
+    void Uplink::acknowledge(const uint32_t sequence) {
+        std::lock_guard guard(lock);
+        const Pending *acked = find(sequence);
+        if (!acked || acked->command.state == State::Queued) return;
+
+        const auto now = Clock::now();
+        for (Pending &p: queue) {
+            Command &c = p.command;
+            if (c.sequence > sequence) break;
+            if (c.sequence == sequence) {
+                // a late acknowledgement still means the command got there
+                if (c.state == State::Sent || c.state == State::Failed || c.state == State::Superseded) {
+                    c.state = State::Acked;
+                    c.acked = now;
+                }
+            } else if (c.state == State::Queued || c.state == State::Sent || c.state == State::Failed) {
+                // the car has moved past it, so it must never be sent again
+                c.state = State::Superseded;
+            }
+        }
+    }
+
+    void Uplink::set_ack_tracking(const bool tracking) {
+        std::lock_guard guard(lock);
+        this->tracking = tracking;
+    }
+
+    bool Uplink::ack_tracking() const {
+        std::lock_guard guard(lock);
+        return tracking;
+    }
+
+    std::vector<Uplink::Command> Uplink::commands() const {
+        std::lock_guard guard(lock);
+        std::vector<Command> out;
+        out.reserve(queue.size());
+        for (const Pending &p: queue) {
+            out.push_back(p.command);
+        }
+        return out;
+    }
+
+    uint64_t Uplink::write_errors() const {
+        std::lock_guard guard(lock);
+        return errors;
+    }
+
+    Uplink::Pending *Uplink::find(const uint32_t sequence) {
+        const auto it = std::ranges::find(queue, sequence, [](const Pending &p) { return p.command.sequence; });
+        return it == queue.end() ? nullptr : &*it;
+    }
+
+    void Uplink::run() {
+        const auto timeout = std::chrono::milliseconds(UPLINK_ACK_TIMEOUT_MS);
+        std::unique_lock guard(lock);
+        while (!stopping) {
+            // the oldest command that is due, and otherwise when the next one will be
+            const auto now = Clock::now();
+            auto next = Clock::time_point::max();
+            const Pending *due = nullptr;
+            for (Pending &p: queue) {
+                Command &c = p.command;
+                if (c.state == State::Queued) {
+                    due = &p;
+                    break;
+                }
+                if (c.state != State::Sent) continue;
+                if (now < c.sent + timeout) {
+                    next = std::min(next, c.sent + timeout);
+                } else if (&p != &queue.back()) {
+                    // a newer command has been queued; resending this one after it would undo it
+                    c.state = State::Superseded;
+                } else if (c.attempts >= UPLINK_ATTEMPTS) {
+                    c.state = State::Failed;
+                } else {
+                    due = &p;
+                    break;
+                }
+            }
+            if (!due) {
+                if (next == Clock::time_point::max()) {
+                    wake.wait(guard);
+                } else {
+                    wake.wait_until(guard, next);
+                }
+                continue;
+            }
+
+            // written without the lock, so send and acknowledge never wait for the port
+            const uint32_t sequence = due->command.sequence;
+            const auto frame = due->frame;
+            guard.unlock();
+            const bool written = serial->put_bytes(reinterpret_cast<const char *>(frame.data()), BUFFER_LENGTH);
+            guard.lock();
+
+            if (!written) errors++;
+            Pending *p = find(sequence);
+            if (!p) continue;
+            p->command.attempts++;
+            p->command.sent = Clock::now();
+            // acknowledged or superseded while being written: nothing left to do
+            if (p->command.state == State::Acked || p->command.state == State::Superseded) continue;
+            // a failed write is retried after the timeout like a lost one
+            p->command.state = written && !tracking ? State::Unconfirmed : State::Sent;
+        }
+    }
+} // DS
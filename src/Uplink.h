@@ -0,0 +1,153 @@
+/* date = October 18, 2026 1:45 AM */
+
+
+#ifndef UPLINK_H
+#define UPLINK_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IOSerial.h"
+#include "RS-FEC.h"
+#include "common.h"
+
+namespace DS {
+    /*
+     * Uplink ("GCS ") frame before RS-FEC encoding, MSG_LENGTH bytes, integers in host (little-endian) byte order:
+     *   "GCS " header (4 bytes), command body (UPLINK_BODY_LENGTH bytes), "UKSC" footer (4 bytes),
+     *   sequence number (u32), zero padding
+     * The sequence number sits in what used to be padding, so the fields the car already reads haven't moved.
+     */
+    constexpr size_t UPLINK_BODY_LENGTH = 12;
+    constexpr size_t UPLINK_SEQUENCE_OFFSET = 4 + UPLINK_BODY_LENGTH + 4;
+
+    /**
+     * Sends commands to the car from a queue, on its own thread, until the car acknowledges them.
+     *
+     * Every command gets a sequence number. The car is expected to echo the number of the last command it received
+     * in the telemetry field named by `ack` in the config's `[uplink]` table, so an acknowledgement also settles every
+     * older command. A command that isn't acknowledged within UPLINK_ACK_TIMEOUT_MS is sent again, up to
+     * UPLINK_ATTEMPTS times, unless a newer command has been queued since: each command replaces the car's settings,
+     * so resending an older one after a newer one would bring back stale settings. Without an ack field there is no
+     * way to know whether a command arrived, so commands are sent once and only repeated if the write itself failed.
+     *
+     * `send` only queues, so the UI never waits on the serial port, and write errors are counted instead of ending the
+     * program.
+     */
+    class Uplink {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        enum class State {
+            // waiting to be written
+            Queued,
+            // written, waiting for the acknowledgement (or, after a failed write, for the next attempt)
+            Sent,
+            Acked,
+            // written, but the config has no ack field to confirm it with
+            Unconfirmed,
+            // every attempt went unacknowledged
+            Failed,
+            // not acknowledged itself, but replaced by a newer command before it could be retried or after the car
+            // acknowledged a newer one
+            Superseded,
+        };
+
+        /**
+         * A command as shown in the sender window.
+         */
+        struct Command {
+            uint32_t sequence;
+            std::string label;
+            State state;
+            // times written so far
+            int attempts;
+            Clock::time_point queued;
+            Clock::time_point sent;
+            Clock::time_point acked;
+        };
+
+        Uplink() = default;
+        ~Uplink();
+
+        Uplink(const Uplink &) = delete;
+        Uplink &operator=(const Uplink &) = delete;
+
+        /**
+         * Starts the writer thread.
+         * @param serial Port to write to; must outlive this Uplink or the next `close`.
+         */
+        void open(IOSerial *serial);
+
+        /**
+         * Stops the writer thread. Commands not yet written are dropped.
+         */
+        void close();
+
+        /**
+         * Queues a command. Never waits on the serial port.
+         * @param label Shown in the sender window.
+         * @param body Command body, placed between the frame's header and footer.
+         * @return Sequence number of the command, or std::nullopt if the uplink isn't open or UPLINK_QUEUE_LIMIT
+         * commands are still unfinished.
+         */
+        std::optional<uint32_t> send(std::string label, std::span<const uint8_t, UPLINK_BODY_LENGTH> body);
+
+        /**
+         * Marks the command with this sequence number as received by the car, and older unfinished ones as
+         * superseded. Repeats are harmless, since the car keeps reporting the last command it got. Numbers of commands
+         * never sent, such as one the car still reports from before a restart, are ignored.
+         */
+        void acknowledge(uint32_t sequence);
+
+        /**
+         * @param tracking Whether the config names an ack field, so commands should be retried until acknowledged.
+         */
+        void set_ack_tracking(bool tracking);
+
+        [[nodiscard]] bool ack_tracking() const;
+
+        /**
+         * @return Unfinished commands and the last UPLINK_HISTORY finished ones, oldest first.
+         */
+        [[nodiscard]] std::vector<Command> commands() const;
+
+        /**
+         * @return Writes to the serial port that failed.
+         */
+        [[nodiscard]] uint64_t write_errors() const;
+
+    private:
+        struct Pending {
+            Command command;
+            std::array<uint8_t, BUFFER_LENGTH> frame;
+        };
+
+        void run();
+        Pending *find(uint32_t sequence);
+
+        IOSerial *serial = nullptr;
+
+        // guards everything below
+        mutable std::mutex lock;
+        RS::ReedSolomon<MSG_LENGTH, ECC_LENGTH> rs{};
+        std::condition_variable wake;
+        // in sequence order
+        std::vector<Pending> queue;
+        uint32_t next_sequence = 1;
+        bool tracking = false;
+        bool stopping = false;
+        uint64_t errors = 0;
+
+        std::thread worker;
+    };
+} // DS
+
+#endif //UPLINK_H
@@ -22,6 +22,7 @@
 #include "backends/imgui_impl_opengl3.h"
 #include "portable-file-dialogs.h"
 #include "GenerateMap.h"
+#include "MapView.h"
 
 namespace DS {
     void config_select_thread(Window *w) {
@@ -89,11 +90,16 @@ namespace DS {
         ImGui_ImplGlfw_InitForOpenGL(back, true);
         ImGui_ImplOpenGL3_Init("#version 150");
 
+        this->map = std::make_unique<MapView>();
+
         this->target_unix_time = static_cast<int>(std::chrono::duration_cast<std::chrono::seconds>(
             std::chrono::system_clock::now().time_since_epoch()).count());
     }
 
     Window::~Window() {
+        // Tile textures have to go while the GL context is still alive.
+        this->map.reset();
+
         // Gracefully close all library features used.
         ImPlot::DestroyContext();
         ImGui_ImplOpenGL3_Shutdown();
@@ -121,6 +127,7 @@ namespace DS {
         }
 
         // Tell ImGui backends that a new frame is being rendered.
+        const auto build_start = std::chrono::steady_clock::now();
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
@@ -132,6 +139,16 @@ namespace DS {
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
+        // time spent building and submitting this frame, excluding the wait for vsync below
+        const auto build_end = std::chrono::steady_clock::now();
+        this->frame_build_ms = std::chrono::duration<double, std::milli>(build_end - build_start).count();
+        this->frame_peak_accum_ms = std::max(this->frame_peak_accum_ms, this->frame_build_ms);
+        if (build_end - this->frame_peak_mark >= std::chrono::seconds(1)) {
+            this->frame_peak_ms = this->frame_peak_accum_ms;
+            this->frame_peak_accum_ms = 0;
+            this->frame_peak_mark = build_end;
+        }
+
         // Swap rendered framebuffer to front.
         glfwSwapBuffers(back);
     }
@@ -203,6 +220,9 @@ namespace DS {
             std::thread(config_select_thread, this).detach();
         }
 
+        ImGui::Text("Frame: %.0f FPS, build %.2f ms (peak %.2f ms over the last second)",
+                    this->parent->dt > 0 ? 1.0 / this->parent->dt : 0.0, this->frame_build_ms, this->frame_peak_ms);
+
         std::optional<std::string> config_path = this->parent->get_config_path();
         if (config_path.has_value()) {
             ImGui::Text("Current configuration path: %s", config_path->c_str());
@@ -224,18 +244,35 @@ namespace DS {
         ImGui::Begin("Car State");
 
         ImGui::Text("Bitrate: %u", this->parent->bitrate);
+        ImGui::Text("Packets dropped (UI behind): %llu",
+                    static_cast<unsigned long long>(this->parent->packets.overflows()));
+        ImGui::Text("Log rows dropped (disk behind): %llu",
+                    static_cast<unsigned long long>(this->parent->logger.dropped()));
+        if (this->parent->capture) {
+            ImGui::Text("Capture bytes dropped (disk behind): %llu",
+                        static_cast<unsigned long long>(this->parent->capture->dropped()));
+        }
+
+        if (this->parent->parser && this->parent->config.has_value()) {
+            ImGui::Text("FEC (clean / corrected / dropped):");
+            for (int t = BufferParser::UndefinedMessage; t < BufferParser::NumTypes; t++) {
+                const auto type = static_cast<BufferParser::BufferType>(t);
+                const auto [clean, corrected, uncorrectable] = this->parent->parser->fec_stats(type);
+                if (!clean && !corrected && !uncorrectable) continue;
+
+                std::string name = this->parent->id_name(t);
+                if (name.empty()) name = "unknown";
+                ImGui::Text("  %s: %u / %u / %u", name.c_str(), clean, corrected, uncorrectable);
+            }
+        }
 
         ImGui::End();
     }
 
     void Window::map_window() {
+        ImGui::SetNextWindowSize(ImVec2(400, 400), ImGuiCond_FirstUseEver);
         ImGui::Begin("Map");
 
-        static int my_image_width = 0;
-        static int my_image_height = 0;
-        static GLuint my_image_texture = 0;
-        
-        /*
         std::optional<double> lat_opt = parent->get_value<double>("gps.latitude");
         double lat = 0.0;
         if (lat_opt.has_value()) {
@@ -251,51 +288,19 @@ namespace DS {
         } else {
             ImGui::Text("Could not find GPS longitute. Check config and add \"gps.longitude\".");
         }
-        */
-        
-        static double lon = -85.5153;
-        static double lat = 37.0389;
-        
+
         ImGui::Text("Longidude: %f", lon);
         ImGui::Text("Latitude: %f", lat);
+        ImGui::SameLine();
+        ImGui::Text("Track: %zu points", parent->gps_track.size());
 
-        auto currentTime = std::chrono::system_clock::now(); // update every time
-        static auto time = currentTime - std::chrono::seconds(5); // prev time is 5 seconds ago so image comes up immediately
-
-        static int return_code = 0; // whether image was generated successfully
-        if (currentTime >= time + std::chrono::seconds(5)) {
-            // if image loaded 
-            if (my_image_texture != 0) {
-                glDeleteTextures(1, &my_image_texture); // delete from memory
-                my_image_texture = 0;
-            }
-
-            time = currentTime;
-            lon += 1.0;
-            lat += 1.0;
-
-            // TEST THIS, then MOVE TO PERMANENT THREAD!!!!!!!!
-            std::thread([&](){
-                    this->map_generate_lock.lock();
-                    return_code = make_map(lon, lat); // generate new map image
-                    this->map_generate_lock.unlock();
-            }).detach();
-
-            if (this->map_generate_lock.try_lock()) {
-                if (std::filesystem::exists("map.png")) {
-                    bool ret = load_texture_from_file("map.png", &my_image_texture, &my_image_width, &my_image_height); // load image into memory
-                    IM_ASSERT(ret);
-                }
-                this->map_generate_lock.unlock();
-            }
-        }
-    
-        if (return_code == 1) {
-            ImGui::Text("Error generating map. Probably no internet.");
+        // above the map, which takes the rest of the window
+        if (this->map->failing()) {
+            ImGui::Text("Error loading map tiles. Probably no internet.");
         }
 
-        ImGui::Image(static_cast<ImTextureID>(my_image_texture), ImVec2(my_image_width, my_image_height));
-        
+        this->map->draw(lon, lat, parent->gps_track);
+
         ImGui::End();
     }
 
@@ -316,6 +321,74 @@ namespace DS {
             parent->send_strategy(this->target_soc, this->target_unix_time, this->target_interval);
         }
 
+        // commands still on their way, and the last few that finished
+        ImGui::Separator();
+        const Uplink &uplink = this->parent->uplink;
+        if (!uplink.ack_tracking()) {
+            ImGui::Text("No [uplink] ack field in the config: commands can't be confirmed or retried.");
+        }
+        if (const uint64_t errors = uplink.write_errors()) {
+            ImGui::Text("Serial write errors: %llu", static_cast<unsigned long long>(errors));
+        }
+        const auto now = Uplink::Clock::now();
+        const auto ms = [](const Uplink::Clock::duration d) {
+            return static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(d).count());
+        };
+        const std::vector<Uplink::Command> commands = uplink.commands();
+        for (auto it = commands.rbegin(); it != commands.rend(); ++it) {
+            const Uplink::Command &c = *it;
+            switch (c.state) {
+                case Uplink::State::Queued:
+                    ImGui::Text("#%u %s: queued for %lld ms", c.sequence, c.label.c_str(), ms(now - c.queued));
+                    break;
+                case Uplink::State::Sent:
+                    ImGui::Text("#%u %s: sent %d/%d, waiting %lld ms", c.sequence, c.label.c_str(), c.attempts,
+                                UPLINK_ATTEMPTS, ms(now - c.sent));
+                    break;
+                case Uplink::State::Acked:
+                    ImGui::Text("#%u %s: acknowledged after %lld ms (%d sent)", c.sequence, c.label.c_str(),
+                                ms(c.acked - c.queued), c.attempts);
+                    break;
+                case Uplink::State::Unconfirmed:
+                    ImGui::Text("#%u %s: sent", c.sequence, c.label.c_str());
+                    break;
+                case Uplink::State::Failed:
+                    ImGui::Text("#%u %s: no acknowledgement after %d tries", c.sequence, c.label.c_str(), c.attempts);
+                    break;
+                case Uplink::State::Superseded:
+                    ImGui::Text("#%u %s: replaced by a newer command (%d sent)", c.sequence, c.label.c_str(),
+                                c.attempts);
+                    break;
+            }
+        }
+
+        ImGui::End();
+    }
+
+    void Window::graph_editor_window() {
+        ImGui::Begin("Graphs");
+
+        if (!this->parent->config.has_value()) {
+            ImGui::Text("No configuration selected.");
+            ImGui::End();
+            return;
+        }
+
+        // picking an existing graph loads it into the editor
+        for (const auto &g: this->parent->get_graphs()) {
+            if (ImGui::Selectable(g->get_name())) {
+                snprintf(this->graph_name, sizeof(this->graph_name), "%s", g->get_name());
+                snprintf(this->graph_formula, sizeof(this->graph_formula), "%s", g->get_formula().c_str());
+            }
+        }
+
+        ImGui::Separator();
+        ImGui::InputText("Name", this->graph_name, sizeof(this->graph_name));
+        ImGui::InputText("Formula", this->graph_formula, sizeof(this->graph_formula));
+        if (ImGui::Button("Add / Update") && this->graph_name[0] && this->graph_formula[0]) {
+            this->parent->set_graph(this->graph_name, this->graph_formula);
+        }
+
         ImGui::End();
     }
 
@@ -323,12 +396,13 @@ namespace DS {
         app_state_window();
         car_state_window();
         map_window();
+        graph_editor_window();
 
         if (!parent->config.has_value()) return;
-        for (auto g: parent->get_graphs()) {
-            ImGui::Begin(g.get_name());
+        for (const auto &g: parent->get_graphs()) {
+            ImGui::Begin(g->get_name());
 
-            g.display();
+            g->display();
 
             ImGui::End();
         }
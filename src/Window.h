@@ -4,6 +4,8 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
+#include <chrono>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
@@ -13,6 +15,7 @@
 
 namespace DS {
 class Dashboard;
+class MapView;
 
 class Window {
     typedef std::vector<std::pair<double, double>> Graphable;
@@ -83,6 +86,7 @@ public:
     void car_state_window();
     void map_window();
     void send_data_window();
+    void graph_editor_window();
 
     static std::string motor_error_string(MotorErrorBits b);
 
@@ -113,8 +117,18 @@ private:
     // determines whether constructor has completed. useful for knowing if ImGUI has fully initialized or not during construction.
     bool init = false;
 
-    // used by the map_window function call to properly handle map generation semantics
-    std::mutex map_generate_lock;
+    // CPU time of the last frame and the worst frame of the previous second, shown in the app state window
+    double frame_build_ms{};
+    double frame_peak_ms{};
+    double frame_peak_accum_ms{};
+    std::chrono::steady_clock::time_point frame_peak_mark{};
+
+    // text fields of the graph editor
+    char graph_name[64]{};
+    char graph_formula[256]{};
+
+    // the map window's map and its tiles; created once the GL context exists and destroyed before it goes away
+    std::unique_ptr<MapView> map;
 };
 
 } // DS
@@ -22,6 +22,42 @@ constexpr int TIME_OFFSET = 6;
 constexpr int DATA_OFFSET = TIME_OFFSET + sizeof(int);
 constexpr int DATA_LENGTH = BUFFER_LENGTH - DATA_OFFSET;
 
+// size of the chunk the telemetry thread pulls from serial at once, and how long a read may wait for data
+constexpr size_t READ_CHUNK_SIZE = 4096;
+constexpr unsigned int READ_TIMEOUT_MS = 100;
+// line rate assumed when replaying a raw capture without --baud
+constexpr int REPLAY_DEFAULT_BAUD = 115200;
+
+// packets buffered between the telemetry thread and the UI thread (must be a power of two). At a few hundred packets
+// per second this covers several seconds of UI stall before packets are dropped.
+constexpr size_t PACKET_QUEUE_CAPACITY = 4096;
+
+// rows buffered between the logging thread and the CSV writer (must be a power of two), bytes batched per CSV file
+// before writing, and the longest a row may sit in memory before it is written
+constexpr size_t LOG_QUEUE_CAPACITY = 8192;
+constexpr size_t LOG_BUFFER_BYTES = 64 * 1024;
+constexpr unsigned int LOG_FLUSH_INTERVAL_MS = 1000;
+constexpr unsigned int LOG_IDLE_SLEEP_MS = 5;
+
+// bytes of raw serial data a capture holds in memory while the disk catches up (must be a power of two); at 115200
+// baud this is several minutes of stall
+constexpr size_t CAPTURE_RING_BYTES = 4 << 20;
+
+// uplink commands that may be waiting to be sent or acknowledged at once, how long the car has to acknowledge one
+// before it is sent again, how many times it is sent before giving up, and finished commands kept for the sender window
+constexpr size_t UPLINK_QUEUE_LIMIT = 32;
+constexpr unsigned int UPLINK_ACK_TIMEOUT_MS = 1000;
+constexpr int UPLINK_ATTEMPTS = 5;
+constexpr size_t UPLINK_HISTORY = 16;
+
+// seconds of data a graph shows when the config doesn't give a "length"
+constexpr double DEFAULT_GRAPH_WIDTH = 20.0;
+// points a graph keeps when the config doesn't give a "capacity" (about 18 minutes at 60 updates a second)
+constexpr size_t DEFAULT_GRAPH_CAPACITY = 1 << 16;
+
+// packets per buffer kept for filling in new graphs (about 87 minutes at 50 packets a second); older ones are dropped
+constexpr size_t FIELD_HISTORY_ROWS = 1 << 18;
+
 constexpr int HOUR_TO_SEC = 60 * 60;
 constexpr int MIN_TO_SEC = 60;
 
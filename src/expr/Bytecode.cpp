@@ -0,0 +1,311 @@
+/* date = October 17, 2026 2:40 PM */
+
+
+#include "Bytecode.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+#include "Parser.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EXPR_SIMD_X86 1
+#include <immintrin.h>
+#define EXPR_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace DS::Expr {
+    // rows evaluated per instruction pass in run_batch; a few blocks of these stay in L1/L2
+    static constexpr size_t BATCH_BLOCK = 512;
+    static double apply_op(const Op op, const double left, const double right) {
+        switch (op) {
+            case Op::Add: return left + right;
+            case Op::Sub: return left - right;
+            case Op::Mul: return left * right;
+            case Op::Div: return left / right;
+            default: return 0;
+        }
+    }
+
+    std::optional<Program> Program::compile(const AST *ast) {
+        if (!ast) return std::nullopt;
+
+        Program p;
+        if (!p.emit(ast, 0)) {
+            std::cerr << "Expression too deeply nested to compile (limit " << MAX_STACK << ").\n";
+            return std::nullopt;
+        }
+        return p;
+    }
+
+    uint32_t Program::slot_of(const std::string &ident) {
+        const auto it = std::ranges::find(slots, ident);
+        if (it != slots.end()) {
+            return static_cast<uint32_t>(it - slots.begin());
+        }
+        slots.push_back(ident);
+        return static_cast<uint32_t>(slots.size() - 1);
+    }
+
+    uint32_t Program::add_constant(const double value) {
+        constants.push_back(value);
+        return static_cast<uint32_t>(constants.size() - 1);
+    }
+
+    /**
+     * Emits code leaving the value of `node` on top of the stack.
+     * @param node Subtree to compile.
+     * @param height Stack height before this subtree runs.
+     * @return false if the stack would exceed MAX_STACK.
+     */
+    bool Program::emit(const AST *node, const size_t height) {
+        if (height + 1 > MAX_STACK) return false;
+        depth = std::max(depth, height + 1);
+
+        switch (node->t.ty) {
+            case Identifier:
+                code.push_back({Op::Load, slot_of(node->t.data)});
+                return true;
+            case Literal: {
+                double value = 0;
+                const std::string &s = node->t.data;
+                std::from_chars(s.data(), s.data() + s.size(), value);
+                code.push_back({Op::Const, add_constant(value)});
+                return true;
+            }
+            case UnaryMinus:
+                if (!node->right || !emit(node->right, height)) return false;
+                if (code.back().op == Op::Const) {
+                    // fold on the double itself, in place
+                    constants[code.back().arg] = -constants[code.back().arg];
+                } else {
+                    code.push_back({Op::Negate, 0});
+                }
+                return true;
+            case Add:
+            case Subtract:
+                if (!node->left) {
+                    // unary form: "+x" or "-x"
+                    if (!node->right || !emit(node->right, height)) return false;
+                    if (node->t.ty == Subtract) {
+                        if (code.back().op == Op::Const) {
+                            constants[code.back().arg] = -constants[code.back().arg];
+                        } else {
+                            code.push_back({Op::Negate, 0});
+                        }
+                    }
+                    return true;
+                }
+                // binary form: same as the other operators
+                [[fallthrough]];
+            case Multiply:
+            case Divide: {
+                if (!node->left || !node->right) return false;
+                if (!emit(node->left, height) || !emit(node->right, height + 1)) return false;
+                switch (node->t.ty) {
+                    case Add: emit_binary(Op::Add); break;
+                    case Subtract: emit_binary(Op::Sub); break;
+                    case Multiply: emit_binary(Op::Mul); break;
+                    default: emit_binary(Op::Div); break;
+                }
+                return true;
+            }
+            default:
+                // invariants of "parse" imply we should not get here.
+                std::cout << "Invalid token type detected" << '\n';
+                exit(-1);
+        }
+    }
+
+    void Program::emit_binary(const Op op) {
+        const size_t n = code.size();
+        if (n >= 2 && code[n - 1].op == Op::Const && code[n - 2].op == Op::Const) {
+            // both operands are constants: fold into the left one and drop the right
+            const double right = constants[code[n - 1].arg];
+            double &left = constants[code[n - 2].arg];
+            left = apply_op(op, left, right);
+            code.pop_back();
+            constants.pop_back();
+            return;
+        }
+        code.push_back({op, 0});
+    }
+
+    double Program::run(const double *slots) const {
+        double stack[MAX_STACK];
+        size_t sp = 0;
+        const double *k = constants.data();
+        for (const auto &[op, arg]: code) {
+            switch (op) {
+                case Op::Const: stack[sp++] = k[arg]; break;
+                case Op::Load: stack[sp++] = slots[arg]; break;
+                case Op::Negate: stack[sp - 1] = -stack[sp - 1]; break;
+                case Op::Add: sp--; stack[sp - 1] += stack[sp]; break;
+                case Op::Sub: sp--; stack[sp - 1] -= stack[sp]; break;
+                case Op::Mul: sp--; stack[sp - 1] *= stack[sp]; break;
+                case Op::Div: sp--; stack[sp - 1] /= stack[sp]; break;
+            }
+        }
+        return sp ? stack[sp - 1] : 0;
+    }
+
+    /* ###################
+     * # BATCH KERNELS   #
+     * ################### */
+
+    // dst[i] = a[i] op b[i]; dst may alias a or b
+    using BinaryKernel = void (*)(Op op, const double *a, const double *b, double *dst, size_t n);
+    // dst[i] = -a[i]; dst may alias a
+    using NegateKernel = void (*)(const double *a, double *dst, size_t n);
+
+    static void binary_scalar(const Op op, const double *a, const double *b, double *dst, const size_t n) {
+        switch (op) {
+            case Op::Add: for (size_t i = 0; i < n; i++) dst[i] = a[i] + b[i]; break;
+            case Op::Sub: for (size_t i = 0; i < n; i++) dst[i] = a[i] - b[i]; break;
+            case Op::Mul: for (size_t i = 0; i < n; i++) dst[i] = a[i] * b[i]; break;
+            case Op::Div: for (size_t i = 0; i < n; i++) dst[i] = a[i] / b[i]; break;
+            default: break;
+        }
+    }
+
+    static void negate_scalar(const double *a, double *dst, const size_t n) {
+        for (size_t i = 0; i < n; i++) dst[i] = -a[i];
+    }
+
+#ifdef EXPR_SIMD_X86
+#define EXPR_BINARY_LOOP(width, load, store, fn) \
+    for (; i + (width) <= n; i += (width)) store(dst + i, fn(load(a + i), load(b + i)))
+
+    EXPR_TARGET("avx")
+    static void binary_avx(const Op op, const double *a, const double *b, double *dst, const size_t n) {
+        size_t i = 0;
+        switch (op) {
+            case Op::Add: EXPR_BINARY_LOOP(4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd); break;
+            case Op::Sub: EXPR_BINARY_LOOP(4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_sub_pd); break;
+            case Op::Mul: EXPR_BINARY_LOOP(4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_mul_pd); break;
+            case Op::Div: EXPR_BINARY_LOOP(4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_div_pd); break;
+            default: return;
+        }
+        binary_scalar(op, a + i, b + i, dst + i, n - i);
+    }
+
+    EXPR_TARGET("avx")
+    static void negate_avx(const double *a, double *dst, const size_t n) {
+        const __m256d sign = _mm256_set1_pd(-0.0);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) _mm256_storeu_pd(dst + i, _mm256_xor_pd(_mm256_loadu_pd(a + i), sign));
+        negate_scalar(a + i, dst + i, n - i);
+    }
+
+    EXPR_TARGET("avx512f")
+    static void binary_avx512(const Op op, const double *a, const double *b, double *dst, const size_t n) {
+        size_t i = 0;
+        switch (op) {
+            case Op::Add: EXPR_BINARY_LOOP(8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_add_pd); break;
+            case Op::Sub: EXPR_BINARY_LOOP(8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_sub_pd); break;
+            case Op::Mul: EXPR_BINARY_LOOP(8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_mul_pd); break;
+            case Op::Div: EXPR_BINARY_LOOP(8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_div_pd); break;
+            default: return;
+        }
+        binary_scalar(op, a + i, b + i, dst + i, n - i);
+    }
+
+    EXPR_TARGET("avx512f")
+    static void negate_avx512(const double *a, double *dst, const size_t n) {
+        // flip the sign bit (avx512f has no floating point xor)
+        const __m512i sign = _mm512_set1_epi64(static_cast<long long>(0x8000000000000000ull));
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m512i v = _mm512_castpd_si512(_mm512_loadu_pd(a + i));
+            _mm512_storeu_pd(dst + i, _mm512_castsi512_pd(_mm512_xor_si512(v, sign)));
+        }
+        negate_scalar(a + i, dst + i, n - i);
+    }
+
+#undef EXPR_BINARY_LOOP
+#endif
+
+    static BatchIsa detect_batch_isa() {
+#ifdef EXPR_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return BatchIsa::AVX512;
+        if (__builtin_cpu_supports("avx")) return BatchIsa::AVX;
+#endif
+        return BatchIsa::Scalar;
+    }
+
+    BatchIsa best_batch_isa() {
+        static const BatchIsa isa = detect_batch_isa();
+        return isa;
+    }
+
+    const char *batch_isa_name(const BatchIsa isa) {
+        switch (isa) {
+            case BatchIsa::AVX: return "AVX";
+            case BatchIsa::AVX512: return "AVX-512";
+            default: return "scalar";
+        }
+    }
+
+    void Program::run_batch(const double *const *columns, const size_t rows, double *out, BatchIsa isa) const {
+        if (isa > best_batch_isa()) isa = best_batch_isa();
+
+        BinaryKernel binary = binary_scalar;
+        NegateKernel negate = negate_scalar;
+#ifdef EXPR_SIMD_X86
+        if (isa == BatchIsa::AVX) {
+            binary = binary_avx;
+            negate = negate_avx;
+        } else if (isa == BatchIsa::AVX512) {
+            binary = binary_avx512;
+            negate = negate_avx512;
+        }
+#endif
+
+        // one scratch block per stack level. operands[i] is where stack level i currently lives: its scratch
+        // block, or straight inside an input column when it was just loaded.
+        const auto scratch = std::make_unique<double[]>(std::max<size_t>(depth, 1) * BATCH_BLOCK);
+        const double *operands[MAX_STACK];
+
+        for (size_t base = 0; base < rows; base += BATCH_BLOCK) {
+            const size_t n = std::min(BATCH_BLOCK, rows - base);
+            size_t sp = 0;
+            for (size_t pc = 0; pc < code.size(); pc++) {
+                const auto &[op, arg] = code[pc];
+                // the last instruction writes the result straight into `out`
+                double *dst = pc + 1 == code.size() ? out + base : nullptr;
+                switch (op) {
+                    case Op::Const: {
+                        if (!dst) dst = &scratch[sp * BATCH_BLOCK];
+                        std::fill_n(dst, n, constants[arg]);
+                        operands[sp++] = dst;
+                        break;
+                    }
+                    case Op::Load:
+                        if (dst) {
+                            memcpy(dst, columns[arg] + base, n * sizeof(double));
+                        }
+                        operands[sp++] = columns[arg] + base;
+                        break;
+                    case Op::Negate:
+                        if (!dst) dst = &scratch[(sp - 1) * BATCH_BLOCK];
+                        negate(operands[sp - 1], dst, n);
+                        operands[sp - 1] = dst;
+                        break;
+                    default:
+                        if (!dst) dst = &scratch[(sp - 2) * BATCH_BLOCK];
+                        binary(op, operands[sp - 2], operands[sp - 1], dst, n);
+                        operands[sp - 2] = dst;
+                        sp--;
+                        break;
+                }
+            }
+            if (code.empty()) {
+                std::fill_n(out + base, n, 0.0);
+            }
+        }
+    }
+} // DS::Expr
@@ -0,0 +1,116 @@
+/* date = October 17, 2026 2:40 PM */
+
+
+#ifndef DELTASTATION_BYTECODE_H
+#define DELTASTATION_BYTECODE_H
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace DS::Expr {
+    struct AST;
+
+    enum class Op : uint8_t {
+        // push constants[arg]
+        Const,
+        // push slots[arg]
+        Load,
+        Negate,
+        Add,
+        Sub,
+        Mul,
+        Div,
+    };
+
+    struct Instruction {
+        Op op;
+        uint32_t arg;
+    };
+
+    // vector width used by `Program::run_batch`
+    enum class BatchIsa {
+        Scalar,
+        // 4 doubles per instruction
+        AVX,
+        // 8 doubles per instruction
+        AVX512,
+    };
+
+    /**
+     * @return Widest batch instruction set supported by the running CPU (detected once).
+     */
+    BatchIsa best_batch_isa();
+
+    const char *batch_isa_name(BatchIsa isa);
+
+    /**
+     * An expression lowered to a flat list of stack machine instructions.
+     *
+     * Every identifier in the expression gets a slot index; `run` reads variables straight out of a slot array, so
+     * evaluating needs no lookups and no allocation. Constant subexpressions are folded while compiling.
+     */
+    class Program {
+    public:
+        // deepest operand stack `run` supports
+        static constexpr size_t MAX_STACK = 64;
+
+        /**
+         * Lowers a parsed expression.
+         * @param ast Root of the expression, as returned by `Parser::parse`.
+         * @return The compiled program, or std::nullopt if `ast` is null or too deeply nested.
+         */
+        static std::optional<Program> compile(const AST *ast);
+
+        /**
+         * Evaluates the program.
+         * @param slots One value per entry of `slot_names()`, in the same order.
+         * @return Value of the expression.
+         */
+        [[nodiscard]] double run(const double *slots) const;
+
+        /**
+         * Evaluates the program once per row of columnar input. Rows are processed in blocks, each instruction
+         * running over a whole block with SIMD before the next one starts. Results are identical to calling `run`
+         * on every row.
+         * @param columns One pointer per entry of `slot_names()`, each to `rows` values.
+         * @param rows Number of rows.
+         * @param out Output, `rows` values.
+         * @param isa Vector width to use; clamped to what the CPU supports.
+         */
+        void run_batch(const double *const *columns, size_t rows, double *out,
+                       BatchIsa isa = best_batch_isa()) const;
+
+        /**
+         * @return Identifier bound to each slot, in slot order.
+         */
+        [[nodiscard]] const std::vector<std::string> &slot_names() const {
+            return slots;
+        }
+
+        [[nodiscard]] const std::vector<Instruction> &instructions() const {
+            return code;
+        }
+
+        [[nodiscard]] const std::vector<double> &constant_pool() const {
+            return constants;
+        }
+
+        [[nodiscard]] size_t stack_depth() const {
+            return depth;
+        }
+
+    private:
+        uint32_t slot_of(const std::string &ident);
+        uint32_t add_constant(double value);
+        bool emit(const AST *node, size_t height);
+        void emit_binary(Op op);
+
+        std::vector<Instruction> code;
+        std::vector<double> constants;
+        std::vector<std::string> slots;
+        size_t depth = 0;
+    };
+} // DS::Expr
+
+#endif //DELTASTATION_BYTECODE_H
@@ -3,7 +3,16 @@
 
 #include "Parser.h"
 
+#include <charconv>
+
 namespace DS::Expr {
+    // shortest representation that parses back to exactly `value` (std::to_string keeps only 6 decimals)
+    static std::string format_double(const double value) {
+        char buf[32];
+        const auto [end, _] = std::to_chars(buf, buf + sizeof(buf), value);
+        return {buf, end};
+    }
+
     void AST::apply(const std::string &ident, double value) {
         if (!this->idents.contains(ident)) return;
         std::vector<AST *> applicants;
@@ -15,7 +24,7 @@ namespace DS::Expr {
                 case Identifier:
                     if (curr->t.data == ident) {
                         curr->t.ty = Literal;
-                        curr->t.data = std::to_string(value);
+                        curr->t.data = format_double(value);
                     }
                     break;
                 case Add:
@@ -51,7 +60,7 @@ namespace DS::Expr {
                     if (node->right->t.ty == Literal) {
                         double right = std::stod(node->right->t.data);
                         node->t.ty = Literal;
-                        node->t.data = std::to_string(-right);
+                        node->t.data = format_double(-right);
                         delete node->right;
                         node->right = nullptr;
                     }
@@ -61,7 +70,7 @@ namespace DS::Expr {
                     if (node->left->t.ty == Literal && node->right->t.ty == Literal) {
                         double left = std::stod(node->left->t.data), right = std::stod(node->right->t.data);
                         node->t.ty = Literal;
-                        node->t.data = std::to_string(left + right);
+                        node->t.data = format_double(left + right);
                         delete node->left;
                         delete node->right;
                         node->left = nullptr;
@@ -74,7 +83,7 @@ namespace DS::Expr {
                     if (node->left->t.ty == Literal && node->right->t.ty == Literal) {
                         double left = std::stod(node->left->t.data), right = std::stod(node->right->t.data);
                         node->t.ty = Literal;
-                        node->t.data = std::to_string(left - right);
+                        node->t.data = format_double(left - right);
                         delete node->left;
                         delete node->right;
                         node->left = nullptr;
@@ -87,7 +96,7 @@ namespace DS::Expr {
                     if (node->left->t.ty == Literal && node->right->t.ty == Literal) {
                         double left = std::stod(node->left->t.data), right = std::stod(node->right->t.data);
                         node->t.ty = Literal;
-                        node->t.data = std::to_string(left * right);
+                        node->t.data = format_double(left * right);
                         delete node->left;
                         delete node->right;
                         node->left = nullptr;
@@ -100,7 +109,7 @@ namespace DS::Expr {
                     if (node->left->t.ty == Literal && node->right->t.ty == Literal) {
                         double left = std::stod(node->left->t.data), right = std::stod(node->right->t.data);
                         node->t.ty = Literal;
-                        node->t.data = std::to_string(left / right);
+                        node->t.data = format_double(left / right);
                         delete node->left;
                         delete node->right;
                         node->left = nullptr;
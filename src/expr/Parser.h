@@ -15,6 +15,14 @@ namespace DS::Expr {
         std::unordered_set<std::string> idents;
         AST *left{}, *right{};
 
+        AST() = default;
+        AST(const AST &) = delete;
+        AST &operator=(const AST &) = delete;
+        ~AST() {
+            delete left;
+            delete right;
+        }
+
         void apply(const std::string &ident, double value);
         void fold();
 
@@ -1,59 +1,220 @@
+#include <atomic>
+#include <filesystem>
 #include <iostream>
+#include <span>
 #include <thread>
+#include <vector>
 
 #include <toml++/toml.hpp>
 
+#include "Benchmark.h"
 #include "BufferParser.h"
+#include "Capture.h"
 #include "Dashboard.h"
 #include "DebugReader.h"
+#include "Importer.h"
 #include "InputParameters.h"
 #include "IOSerial.h"
+#include "ReplayReader.h"
+#include "SyntheticReader.h"
+#include "TilePrefetch.h"
 #include "expr/Lexer.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <csignal>
+#include <pthread.h>
+#endif
+
 // constexpr vs const: const is stored in the compiled binary, constexpr is optimized away by the compiler (and can also
 // be used by templates.)
 
+// set by the telemetry thread when a headless session ends because the serial port went away
+static std::atomic<bool> serial_lost{false};
+
 // TODO: what if the car stops sending data? does the window updater fail?
-void telemetry_thread(DS::BufferParser *bp, DS::Dashboard *db, DS::IOSerial *s) {
+void telemetry_thread(DS::BufferParser *bp, DS::Dashboard *db, DS::IOSerial *s, DS::Capture *capture) {
+    // a single read can carry several packets at high baud rates, so serial is drained in chunks
+    // rather than one byte per call.
+    uint8_t chunk[READ_CHUNK_SIZE];
     while (!db->should_close()) {
-        if (s->available()) {
-            bp->put_byte(s->get_byte());
-            db->byte_increment();
+        const int n = s->read_bytes(chunk, READ_TIMEOUT_MS);
+        if (n < 0) {
+            std::cerr << "Serialib Error: read failed with code " << n << ".\n";
+            // with a window, the UI loop notices the disconnect; headless, nothing else is watching
+            if (db->is_headless() && !s->get_backend().isDeviceOpen()) {
+                std::cerr << "Serialib Error: backend disconnected." << std::endl;
+                serial_lost.store(true);
+                db->request_close();
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(READ_TIMEOUT_MS));
+            continue;
+        }
+        if (n == 0 && s->at_end()) {
+            // a replay ran out; headless there is nothing left to do, with a window the data stays up
+            std::cout << "Replay finished.\n";
+            if (db->is_headless()) {
+                db->request_close();
+            }
+            return;
+        }
+        db->byte_increment(n);
+
+        std::span<const uint8_t> rest{chunk, static_cast<size_t>(n)};
+        if (capture) {
+            // the bytes as they came off the wire, before the parser drops or repairs anything
+            capture->record(rest);
         }
-        if (bp->ready()) {
-            db->lock();
-            db->consume(bp->get_buffer());
-            db->unlock();
+        while (!rest.empty()) {
+            rest = rest.subspan(bp->put_bytes(rest));
+            if (bp->ready()) {
+                db->push_packet(bp->get_buffer());
+            }
         }
     }
 }
 
+#ifdef _WIN32
+static DS::Dashboard *stop_target = nullptr;
+#endif
+
+#ifndef _WIN32
+static sigset_t stop_signals() {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    return set;
+}
+#endif
+
+/**
+ * Blocks Ctrl+C (and SIGTERM) so they can only be taken by `handle_stop_signals`.
+ * NOTE: must be called before any other thread is started (the Dashboard starts the logger's), since POSIX threads
+ * inherit the signal mask; a thread without the signals blocked could take one and end the process unflushed.
+ */
+static void block_stop_signals() {
+#ifndef _WIN32
+    const sigset_t set = stop_signals();
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+#endif
+}
+
+/**
+ * Makes Ctrl+C (and SIGTERM) end a headless session the way closing the window does, so the logs are flushed.
+ * NOTE: `block_stop_signals` must have been called first.
+ */
+static void handle_stop_signals(DS::Dashboard *db) {
+#ifdef _WIN32
+    stop_target = db;
+    SetConsoleCtrlHandler([](DWORD) -> BOOL {
+        stop_target->request_close();
+        return TRUE;
+    }, TRUE);
+#else
+    // the signals are taken synchronously here, so the handler can do more than a signal handler could
+    std::thread([db, set = stop_signals()] {
+        int sig;
+        sigwait(&set, &sig);
+        db->request_close();
+    }).detach();
+#endif
+}
+
 int main(const int argc, char *argv[]) {
     auto in = DS::InputParameters(argc, argv);
+    if (in.bench_fec()) {
+        DS::fec_benchmark();
+        return 0;
+    }
+    if (in.bench_graphs()) {
+        return DS::graph_benchmark();
+    }
+    if (in.prefetch_mode()) {
+        return DS::prefetch_tiles(in.get_prefetch());
+    }
+    if (in.import_mode()) {
+        if (!std::filesystem::exists(in.get_config())) {
+            std::cerr << "Import: config file " << in.get_config() << " not found.\n";
+            return 1;
+        }
+        const DS::Config config{in.get_config()};
+        const std::vector<std::filesystem::path> paths{in.get_import_paths().begin(), in.get_import_paths().end()};
+        return DS::import_csv(config, paths);
+    }
+
+    if (in.headless()) {
+        // there is no window to pick a config from, and without one nothing would be logged
+        if (!std::filesystem::exists(in.get_config())) {
+            std::cerr << "Headless: config file " << in.get_config() << " not found.\n";
+            return 1;
+        }
+        block_stop_signals();
+    }
+
     // TODO: local on stack or global with singletons?
     DS::BufferParser bp{};
-    DS::Dashboard db{};
+    DS::Dashboard db{in.headless()};
 
     if (in.debug_mode()) {
         db.serial = new DS::DebugReader();
         db.set_debug_mode();
         std::cout << "Serial output connected to standard output.\n";
         DS::Expr::test_lexer();
+    } else if (in.replay_mode()) {
+        const int baud = in.get_baud() > 0 ? in.get_baud() : REPLAY_DEFAULT_BAUD;
+        db.serial = new DS::ReplayReader(in.get_replay_path(), in.get_replay_speed(), baud);
+        // keep replayed data apart from real car data
+        db.set_debug_mode();
+    } else if (in.synthetic_mode()) {
+        if (!std::filesystem::exists(in.get_config())) {
+            std::cerr << "Synthetic: config file " << in.get_config() << " not found.\n";
+            return 1;
+        }
+        db.serial = new DS::SyntheticReader(DS::Config{in.get_config()}, in.get_replay_speed());
+        db.set_debug_mode();
     } else {
         db.serial = new DS::IOSerial(in.get_port(), in.get_baud());
     }
 
     DS::IOSerial *s = db.serial;
+    db.parser = &bp;
+    db.uplink.open(s);
 
     db.set_config(in.get_config());
 
     if (in.debug_mode())
         db.debug_print_packet_ids();
 
-    std::thread t = std::thread(telemetry_thread, &bp, &db, s);
+    if (in.headless()) {
+        handle_stop_signals(&db);
+    }
+
+    DS::Capture capture;
+    if (in.capture_mode()) {
+        if (!capture.open(in.get_capture_path())) {
+            return 1;
+        }
+        db.capture = &capture;
+        std::cout << "Capturing serial bytes to " << in.get_capture_path() << ".\n";
+    }
+
+    std::thread t = std::thread(telemetry_thread, &bp, &db, s, capture.is_open() ? &capture : nullptr);
+    if (in.headless()) {
+        // all the work happens on the telemetry thread as packets arrive
+        std::cout << "Running headless, logging to " << db.get_csv_storage_path().string()
+                  << ". Press Ctrl+C to stop.\n";
+        db.wait_for_close();
+        t.join();
+        return serial_lost.load() ? 1 : 0;
+    }
     while (!db.should_close()) {
         // TODO: prompt reconnection...
-        if (!in.debug_mode() && !s->get_backend().isDeviceOpen()) {
+        if (!in.debug_mode() && !in.replay_mode() && !in.synthetic_mode() && !s->get_backend().isDeviceOpen()) {
             std::cerr << "Serialib Error: backend disconnected." << std::endl;
             exit(-1);
         }